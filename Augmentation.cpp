@@ -0,0 +1,138 @@
+#include "Augmentation.h"
+#include "Drawing.h"
+#include "Interpolation.h"
+#include "Parallel.h"
+#include "Random.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/**
+ * @brief Constructor
+ * @param params Augmentation ranges
+ * @param seed Seed value
+ */
+Augmentation::Augmentation(const AugmentationParameters& params, uint64_t seed)
+    : params(params), seed(seed), counter(0) {}
+
+/**
+ * @brief Generates one sample
+ * @param src Source grayscale image
+ * @param index Sample index
+ * @param dst Destination grayscale image
+ * @details Output pixel centers p map to source positions
+ *          s = c + R(angle) * S(shear) * diag(flipX * sx, flipY * sy) * (p - o)
+ *          where o is the output center, c the crop center and sx, sy the crop scale.
+ *          All random parameters are drawn first, in a fixed order, from a generator
+ *          seeded by (seed, index)
+ */
+void Augmentation::generate(const Image& src, uint64_t index, Image& dst) const {
+    unsigned int outWidth = params.width ? params.width : src.width();
+    unsigned int outHeight = params.height ? params.height : src.height();
+    dst = Image(outWidth, outHeight);
+    if (outWidth == 0 || outHeight == 0 || src.width() == 0 || src.height() == 0) {
+        return;
+    }
+
+    uint64_t sampleSeed = seed ^ (index * 0xD1B54A32D192ED03ull);
+    Random::Generator rng(sampleSeed);
+
+    // Geometry
+    double scale = rng.uniform(std::min(params.minCropScale, 1.0), 1.0);
+    double cropWidth = src.width() * scale;
+    double cropHeight = src.height() * scale;
+    double cx = rng.uniform(0.0, src.width() - cropWidth) + cropWidth / 2;
+    double cy = rng.uniform(0.0, src.height() - cropHeight) + cropHeight / 2;
+    double flipX = params.horizontalFlip && (rng.next() & 1) ? -1.0 : 1.0;
+    double flipY = params.verticalFlip && (rng.next() & 1) ? -1.0 : 1.0;
+    double angle = rng.uniform(-params.maxRotation, params.maxRotation) * 3.14159265358979323846 / 180.0;
+    double shear = rng.uniform(-params.maxShear, params.maxShear);
+
+    double sx = flipX * cropWidth / outWidth;
+    double sy = flipY * cropHeight / outHeight;
+    double cosA = std::cos(angle), sinA = std::sin(angle);
+    // R * S * D with S = [[1, shear], [0, 1]]
+    double a00 = cosA * sx, a01 = (cosA * shear - sinA) * sy;
+    double a10 = sinA * sx, a11 = (sinA * shear + cosA) * sy;
+    double ox = outWidth / 2.0, oy = outHeight / 2.0;
+    // Source pixel coordinate (centers at integers) of output pixel (0,0) center
+    double b0 = cx - 0.5 + a00 * (0.5 - ox) + a01 * (0.5 - oy);
+    double b1 = cy - 0.5 + a10 * (0.5 - ox) + a11 * (0.5 - oy);
+
+    // Photometric
+    double gamma = rng.uniform(1.0 - params.gammaJitter, 1.0 + params.gammaJitter);
+    double contrast = rng.uniform(1.0 - params.contrastJitter, 1.0 + params.contrastJitter);
+    int brightness = params.brightnessJitter > 0
+        ? static_cast<int>(rng.below(2 * params.brightnessJitter + 1)) - params.brightnessJitter : 0;
+    PointOperationChain chain;
+    chain.then(GammaCorrection(gamma)).then(BrightnessContrastAdjustment(contrast, brightness));
+    std::array<unsigned char, 256> lut = chain.lookupTable();
+
+    Random::LaneGenerator noise(sampleSeed + 1);
+    int noiseScale = static_cast<int>(std::lround(params.noiseSigma / Random::LaneGenerator::normalSigma * 65536.0));
+    std::vector<int> noiseRow(noiseScale ? outWidth : 0);
+
+    float srcWidth = static_cast<float>(src.width());
+    float srcHeight = static_cast<float>(src.height());
+
+    for (unsigned int y = 0; y < outHeight; ++y) {
+        double X = b0 + a01 * y;
+        double Y = b1 + a11 * y;
+        unsigned char* out = dst.row(y);
+
+        for (unsigned int x = 0; x < outWidth; ++x, X += a00, Y += a10) {
+            float fx = static_cast<float>(X);
+            float fy = static_cast<float>(Y);
+            if (!(fx > -1.0f && fy > -1.0f && fx < srcWidth && fy < srcHeight)) { // Also catches NaN
+                out[x] = params.border;
+                continue;
+            }
+            // Edge pixels whose center lies less than a pixel outside are clamped
+            int fixedX = std::max(0, static_cast<int>(fx * 256.0f + 0.5f));
+            int fixedY = std::max(0, static_cast<int>(fy * 256.0f + 0.5f));
+            unsigned int ix = std::min(static_cast<unsigned int>(fixedX >> 8), src.width() - 1);
+            unsigned int iy = std::min(static_cast<unsigned int>(fixedY >> 8), src.height() - 1);
+            out[x] = lut[Interpolation::bilinear(src, ix, iy, fixedX & 0xFF, fixedY & 0xFF)];
+        }
+
+        if (noiseScale) {
+            noise.fillNormal(noiseRow.data(), outWidth);
+            for (unsigned int x = 0; x < outWidth; ++x) {
+                int v = out[x] + ((noiseRow[x] * noiseScale + 32768) >> 16);
+                out[x] = static_cast<unsigned char>(std::min(255, std::max(0, v)));
+            }
+        }
+    }
+
+    unsigned int cutWidth = std::max(1u, static_cast<unsigned int>(outWidth * params.cutoutSize));
+    unsigned int cutHeight = std::max(1u, static_cast<unsigned int>(outHeight * params.cutoutSize));
+    for (unsigned int k = 0; k < params.cutouts; ++k) {
+        // The center may lie anywhere, so cutouts can be partially outside
+        int x = static_cast<int>(rng.below(outWidth)) - static_cast<int>(cutWidth / 2);
+        int y = static_cast<int>(rng.below(outHeight)) - static_cast<int>(cutHeight / 2);
+        Drawing::fillRectangle(dst, Rectangle(x, y, cutWidth, cutHeight), params.cutoutValue);
+    }
+}
+
+/**
+ * @brief Generates consecutive samples in parallel
+ * @param src Source grayscale image
+ * @param first Index of the first sample
+ * @param out Vector of samples to fill
+ */
+void Augmentation::generateBatch(const Image& src, uint64_t first, std::vector<Image>& out) const {
+    Parallel::forRange(static_cast<unsigned int>(out.size()), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i) {
+            generate(src, first + i, out[i]);
+        }
+    }, 1);
+}
+
+/**
+ * @brief Generates the next sample
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ */
+void Augmentation::process(const Image& src, Image& dst) {
+    generate(src, counter++, dst);
+}
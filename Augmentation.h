@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Structure holding the ranges of random augmentations
+ */
+struct AugmentationParameters {
+    unsigned int width = 0;             ///< Output width (0: source width)
+    unsigned int height = 0;            ///< Output height (0: source height)
+    double minCropScale = 0.6;          ///< Smallest crop side as a fraction of the source side
+    bool horizontalFlip = true;         ///< Mirror left-right with probability 1/2
+    bool verticalFlip = false;          ///< Mirror top-bottom with probability 1/2
+    double maxRotation = 10.0;          ///< Largest rotation in degrees
+    double maxShear = 0.1;              ///< Largest horizontal shear factor
+    double gammaJitter = 0.2;           ///< Gamma is drawn from [1 - gammaJitter, 1 + gammaJitter]
+    double contrastJitter = 0.2;        ///< Contrast is drawn from [1 - contrastJitter, 1 + contrastJitter]
+    int brightnessJitter = 20;          ///< Brightness offset is drawn from [-brightnessJitter, brightnessJitter]
+    double noiseSigma = 0.0;            ///< Standard deviation of additive Gaussian noise in gray levels
+    unsigned int cutouts = 0;           ///< Number of cutout rectangles
+    double cutoutSize = 0.25;           ///< Cutout side as a fraction of the output side
+    unsigned char cutoutValue = 0;      ///< Gray value of cutout rectangles
+    unsigned char border = 0;           ///< Value for pixels mapping outside the source
+};
+
+/**
+ * @brief Class generating randomly augmented training samples from a grayscale image
+ * @details Sample i depends only on the seed and i, so any sample can be regenerated
+ *          exactly, independent of the order or the thread it is produced on.
+ *
+ *          Crop, flip, rotation and shear are combined into one affine map from the
+ *          output to the source. The crop is never copied: output pixels are sampled
+ *          straight from the source with bilinear interpolation. Gamma, contrast and
+ *          brightness jitter are composed into one lookup table, and noise is added
+ *          from a lane-parallel generator while each row is still in cache. Cutout
+ *          rectangles are filled last.
+ */
+class Augmentation : public ImageProcessing {
+private:
+    AugmentationParameters params;  ///< Augmentation ranges
+    uint64_t seed;                  ///< Seed shared by all samples
+    uint64_t counter;               ///< Index of the next sample produced by process()
+
+public:
+    /**
+     * @brief Constructor
+     * @param params Augmentation ranges
+     * @param seed Seed value (default: 0)
+     */
+    Augmentation(const AugmentationParameters& params, uint64_t seed = 0);
+
+    /**
+     * @brief Generates one sample
+     * @param src Source grayscale image
+     * @param index Sample index
+     * @param dst Destination grayscale image
+     */
+    void generate(const Image& src, uint64_t index, Image& dst) const;
+
+    /**
+     * @brief Generates consecutive samples in parallel
+     * @param src Source grayscale image
+     * @param first Index of the first sample
+     * @param out Vector whose size gives the number of samples; receives samples first, first + 1, ...
+     */
+    void generateBatch(const Image& src, uint64_t first, std::vector<Image>& out) const;
+
+    /**
+     * @brief Generates the next sample
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     */
+    void process(const Image& src, Image& dst) override;
+};
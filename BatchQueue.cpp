@@ -0,0 +1,498 @@
+#include "BatchQueue.h"
+#include "Metrics.h"
+#include "PixelExpression.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Lists the entries of a directory
+ * @param path Directory path
+ * @return Entry names without "." and ".."
+ */
+std::vector<std::string> listDirectory(const std::string& path) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return names;
+    }
+    while (dirent* e = readdir(dir)) {
+        std::string name = e->d_name;
+        if (name != "." && name != "..") {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    return names;
+}
+
+/**
+ * @brief Parses a non-empty sequence of digits
+ * @param s String
+ * @param max Largest accepted value
+ * @param value Receives the number
+ * @return true if s is a number no larger than max
+ */
+bool parseNumber(const std::string& s, long max, long& value) {
+    if (s.empty() || !std::all_of(s.begin(), s.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        return false;
+    }
+    errno = 0;
+    char* end = nullptr;
+    long result = std::strtol(s.c_str(), &end, 10);
+    if (errno == ERANGE || *end != '\0' || result > max) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+}
+
+/**
+ * @brief Constructor
+ * @param jobDir Job directory
+ * @param maxRetries Attempts allowed after the first one
+ */
+BatchQueue::BatchQueue(const std::string& jobDir, unsigned int maxRetries)
+    : root(jobDir), maxRetries(maxRetries) {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') {
+        std::snprintf(name, sizeof(name), "localhost");
+    }
+    host = name;
+    std::replace(host.begin(), host.end(), '@', '_'); // Keep claims parseable
+}
+
+/**
+ * @brief Splits a queue entry name into its parts
+ * @param entry Entry name
+ * @param base Receives the input name
+ * @param attempts Receives the number of failed attempts
+ * @param owner Receives "host.pid" of claims
+ * @details Suffixes that do not parse, including numbers out of range, are treated as
+ *          part of the input name
+ */
+void BatchQueue::parse(const std::string& entry, std::string& base, unsigned int& attempts, std::string& owner) {
+    base = entry;
+    attempts = 0;
+    owner.clear();
+
+    long value = 0;
+    size_t at = base.rfind('@');
+    if (at != std::string::npos) {
+        std::string candidate = base.substr(at + 1);
+        size_t dot = candidate.rfind('.');
+        if (dot != std::string::npos && parseNumber(candidate.substr(dot + 1), std::numeric_limits<pid_t>::max(), value)) {
+            owner = candidate;
+            base.erase(at);
+        }
+    }
+
+    size_t hash = base.rfind('#');
+    if (hash != std::string::npos && parseNumber(base.substr(hash + 1), UINT_MAX - 1, value)) {
+        attempts = static_cast<unsigned int>(value);
+        base.erase(hash);
+    }
+}
+
+/**
+ * @brief Creates the queue directories
+ * @return true if successful
+ */
+bool BatchQueue::prepare() {
+    for (const char* sub : {"", "/pending", "/claimed", "/done", "/quarantine"}) {
+        std::string path = root + sub;
+        if (mkdir(path.c_str(), 0775) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Claims the next pending input for the calling process
+ * @param entry Receives the claimed entry name
+ * @return true if an input was claimed
+ * @details Workers start scanning at different positions to avoid all racing for the
+ *          same entry; losing a race (ENOENT) simply moves on to the next one
+ */
+bool BatchQueue::claim(std::string& entry) {
+    std::vector<std::string> pending = listDirectory(root + "/pending");
+    if (pending.empty()) {
+        return false;
+    }
+    std::sort(pending.begin(), pending.end());
+    size_t start = static_cast<size_t>(getpid()) % pending.size();
+
+    for (size_t k = 0; k < pending.size(); ++k) {
+        const std::string& name = pending[(start + k) % pending.size()];
+        if (name.find(".tmp.") != std::string::npos) {
+            continue; // Input still being copied in
+        }
+        std::string claimed = name + "@" + host + "." + std::to_string(getpid());
+        if (std::rename((root + "/pending/" + name).c_str(), (root + "/claimed/" + claimed).c_str()) == 0) {
+            renew(claimed); // rename keeps the input's mtime, which may be older than any lease
+            entry = claimed;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Gets the path of a claimed input
+ * @param entry Claimed entry name
+ * @return Path of the claimed file
+ */
+std::string BatchQueue::claimedPath(const std::string& entry) const {
+    return root + "/claimed/" + entry;
+}
+
+/**
+ * @brief Stores the result of a claimed input and removes the claim
+ * @param entry Claimed entry name
+ * @param result Processed image
+ * @return true if successful
+ * @details The result is written to a temporary name and renamed, so done/ only ever
+ *          contains complete files
+ */
+bool BatchQueue::complete(const std::string& entry, Image& result) {
+    std::string base, owner;
+    unsigned int attempts;
+    parse(entry, base, attempts, owner);
+
+    std::string temp = root + "/done/" + base + ".tmp." + std::to_string(getpid());
+    if (!result.save(temp) || std::rename(temp.c_str(), (root + "/done/" + base).c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    std::remove(claimedPath(entry).c_str());
+    return true;
+}
+
+/**
+ * @brief Returns a claimed entry to pending/ or moves it to quarantine/
+ * @param entry Claimed entry name
+ * @return true if the entry was quarantined
+ */
+bool BatchQueue::requeue(const std::string& entry) {
+    std::string base, owner;
+    unsigned int attempts;
+    parse(entry, base, attempts, owner);
+
+    ++attempts;
+    bool quarantine = attempts > maxRetries;
+    std::string target = quarantine ? root + "/quarantine/" + base
+                                    : root + "/pending/" + base + "#" + std::to_string(attempts);
+    std::rename(claimedPath(entry).c_str(), target.c_str());
+    return quarantine;
+}
+
+/**
+ * @brief Gives up a claimed input after a failure
+ * @param entry Claimed entry name
+ * @return true if the input was quarantined
+ */
+bool BatchQueue::fail(const std::string& entry) {
+    return requeue(entry);
+}
+
+/**
+ * @brief Releases all claims of a dead process on this host
+ * @param pid Process ID
+ * @param quarantined Receives the number of inputs quarantined
+ * @return Number of claims released
+ */
+unsigned int BatchQueue::recover(pid_t pid, unsigned int& quarantined) {
+    std::string suffix = "@" + host + "." + std::to_string(pid);
+    unsigned int released = 0;
+    quarantined = 0;
+    for (const std::string& name : listDirectory(root + "/claimed")) {
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            quarantined += requeue(name);
+            ++released;
+        }
+    }
+    return released;
+}
+
+/**
+ * @brief Lists the claims of processes on this host
+ * @return Claimed entry names by process ID
+ */
+std::map<pid_t, std::string> BatchQueue::localClaims() const {
+    std::map<pid_t, std::string> claims;
+    for (const std::string& name : listDirectory(root + "/claimed")) {
+        std::string base, owner;
+        unsigned int attempts;
+        parse(name, base, attempts, owner);
+        size_t dot = owner.rfind('.');
+        long pid = 0;
+        if (dot != std::string::npos && owner.substr(0, dot) == host &&
+            parseNumber(owner.substr(dot + 1), std::numeric_limits<pid_t>::max(), pid)) {
+            claims[static_cast<pid_t>(pid)] = name;
+        }
+    }
+    return claims;
+}
+
+/**
+ * @brief Renews the lease of a claim
+ * @param entry Claimed entry name
+ * @return true if the claim still exists
+ * @details Sets the modification time of the claimed file to now
+ */
+bool BatchQueue::renew(const std::string& entry) {
+    return utimensat(AT_FDCWD, claimedPath(entry).c_str(), nullptr, 0) == 0;
+}
+
+/**
+ * @brief Releases claims whose owner is gone
+ * @param lease Seconds after which a claim that was not renewed is released, 0 to never expire claims
+ * @param quarantined Receives the number of inputs quarantined
+ * @return Number of claims released
+ * @details Claims of processes on this host are released exactly when the process no
+ *          longer exists; a live local process never loses its claim. Claims of other
+ *          hosts are released when their lease expired, measured from the later of mtime
+ *          (renewals) and ctime (the claiming rename)
+ */
+unsigned int BatchQueue::recoverOrphans(unsigned int lease, unsigned int& quarantined) {
+    time_t now = std::time(nullptr);
+    unsigned int released = 0;
+    quarantined = 0;
+    for (const std::string& name : listDirectory(root + "/claimed")) {
+        std::string base, owner;
+        unsigned int attempts;
+        parse(name, base, attempts, owner);
+        size_t dot = owner.rfind('.');
+        bool orphan = false;
+        long pid = 0;
+        struct stat st;
+        if (dot != std::string::npos && owner.substr(0, dot) == host && parseNumber(owner.substr(dot + 1), std::numeric_limits<pid_t>::max(), pid)) {
+            orphan = kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH;
+        } else if (lease > 0 && stat(claimedPath(name).c_str(), &st) == 0) {
+            orphan = now - std::max(st.st_mtime, st.st_ctime) > static_cast<time_t>(lease);
+        }
+        if (orphan) {
+            quarantined += requeue(name);
+            ++released;
+        }
+    }
+    return released;
+}
+
+/**
+ * @brief Counts the entries of a queue directory
+ * @param state Directory name
+ * @return Number of entries
+ */
+size_t BatchQueue::count(const std::string& state) const {
+    return listDirectory(root + "/" + state).size();
+}
+
+namespace BatchMode {
+
+namespace {
+
+/**
+ * @brief Worker process main loop
+ * @param queue Job queue
+ * @param expr Compiled expression
+ * @return Exit code (0 when no input is left)
+ * @details A crash while processing leaves the claim behind for the coordinator
+ */
+int worker(BatchQueue& queue, PixelExpression& expr) {
+    std::string entry;
+    while (queue.claim(entry)) {
+        Image img, result;
+        if (!img.load(queue.claimedPath(entry)) || img.isEmpty()) {
+            queue.fail(entry);
+            continue;
+        }
+        expr.process(img, result);
+        if (!queue.complete(entry, result)) {
+            queue.fail(entry);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Forks one worker process
+ * @param queue Job queue
+ * @param expr Compiled expression
+ * @return Child PID, -1 on failure
+ */
+pid_t spawn(BatchQueue& queue, PixelExpression& expr) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(worker(queue, expr));
+    }
+    return pid;
+}
+
+}
+
+/**
+ * @brief Forks workers and supervises them until the queue is drained
+ * @param options Batch settings
+ * @return Exit status
+ * @details The coordinator stays single threaded, so forking is safe. It polls for
+ *          exited children; after an abnormal exit it releases the dead worker's claims
+ *          and starts a replacement while inputs remain. About once per second it checks
+ *          its workers' claims: a worker that spent longer than the timeout on one input
+ *          is killed, and claims are renewed a few times per lease. Expired claims of other
+ *          nodes are released on the same schedule, and the coordinator keeps running
+ *          until claimed/ is empty, so a job survives the loss of any node. Queue sizes
+ *          and restart counts are written as metrics about once per second.
+ */
+int run(const BatchOptions& options) {
+    PixelExpression expr;
+    if (!expr.compile(options.expression) || expr.inputCount() > 1) {
+        std::cerr << "Invalid expression: " << (expr.error().empty() ? "uses more than one input" : expr.error()) << std::endl;
+        return 2;
+    }
+
+    BatchQueue queue(options.jobDir, options.maxRetries);
+    if (!queue.prepare()) {
+        std::cerr << "Cannot create queue directories in " << options.jobDir << std::endl;
+        return 2;
+    }
+
+    Metrics::Gauge pending("imageprocessing_batch_pending", "Inputs waiting in pending/");
+    Metrics::Gauge claimed("imageprocessing_batch_claimed", "Inputs being processed");
+    Metrics::Gauge done("imageprocessing_batch_done", "Results in done/");
+    Metrics::Gauge quarantinedGauge("imageprocessing_batch_quarantined", "Inputs in quarantine/");
+    Metrics::Gauge active("imageprocessing_batch_workers", "Running worker processes");
+    Metrics::Counter crashes("imageprocessing_batch_worker_crashes_total", "Workers that exited abnormally");
+
+    unsigned int quarantined = 0;
+    unsigned int released = queue.recoverOrphans(options.lease, quarantined);
+    if (released > 0) {
+        std::cout << "Recovered " << released << " orphaned claims" << std::endl;
+    }
+
+    unsigned int workers = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+    std::set<pid_t> running;
+    for (unsigned int w = 0; w < workers; ++w) {
+        pid_t pid = spawn(queue, expr);
+        if (pid > 0) {
+            running.insert(pid);
+        }
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    std::map<pid_t, std::pair<std::string, Clock::time_point>> current; // Input each worker is on, and since when
+    unsigned int renewEvery = std::max(1u, options.lease / 4);
+    int tick = 0;
+    while (!running.empty() || (options.lease > 0 && queue.count("claimed") > 0)) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0 && running.erase(pid)) {
+            current.erase(pid);
+            bool crashed = !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+            unsigned int q = 0;
+            unsigned int lost = queue.recover(pid, q);
+            if (crashed) {
+                crashes.add();
+                std::cout << "Worker " << pid << " died, released " << lost << " inputs ("
+                          << q << " quarantined)" << std::endl;
+            }
+            if (queue.count("pending") > 0) {
+                pid_t replacement = spawn(queue, expr);
+                if (replacement > 0) {
+                    running.insert(replacement);
+                }
+            }
+            continue;
+        }
+
+        usleep(50000);
+        if (++tick % 20 != 0) {
+            continue;
+        }
+
+        Clock::time_point now = Clock::now();
+        std::map<pid_t, std::string> claims = queue.localClaims();
+        bool renewNow = (tick / 20) % renewEvery == 0;
+        for (pid_t worker : running) {
+            auto claim = claims.find(worker);
+            if (claim == claims.end()) {
+                current.erase(worker);
+                continue;
+            }
+            auto seen = current.find(worker);
+            if (seen == current.end() || seen->second.first != claim->second) {
+                current[worker] = std::make_pair(claim->second, now);
+            } else if (options.timeout > 0 && now - seen->second.second > std::chrono::seconds(options.timeout)) {
+                std::cout << "Worker " << worker << " exceeded " << options.timeout << " s on "
+                          << claim->second << ", killing it" << std::endl;
+                kill(worker, SIGKILL); // Reaped above like any crash, which requeues the input
+                current.erase(seen);
+                continue;
+            }
+            if (renewNow) {
+                queue.renew(claim->second);
+            }
+        }
+
+        if (renewNow) {
+            unsigned int q = 0;
+            unsigned int taken = queue.recoverOrphans(options.lease, q);
+            if (taken > 0) {
+                std::cout << "Released " << taken << " expired claims (" << q << " quarantined)" << std::endl;
+            }
+        }
+        while (running.size() < workers && queue.count("pending") > 0) {
+            pid_t replacement = spawn(queue, expr);
+            if (replacement <= 0) {
+                break;
+            }
+            running.insert(replacement);
+        }
+
+        if (!options.metricsPath.empty()) {
+            pending.set(static_cast<int64_t>(queue.count("pending")));
+            claimed.set(static_cast<int64_t>(queue.count("claimed")));
+            done.set(static_cast<int64_t>(queue.count("done")));
+            quarantinedGauge.set(static_cast<int64_t>(queue.count("quarantine")));
+            active.set(static_cast<int64_t>(running.size()));
+            Metrics::writeFile(options.metricsPath);
+        }
+    }
+
+    size_t failed = queue.count("quarantine");
+    if (!options.metricsPath.empty()) {
+        pending.set(static_cast<int64_t>(queue.count("pending")));
+        claimed.set(static_cast<int64_t>(queue.count("claimed")));
+        done.set(static_cast<int64_t>(queue.count("done")));
+        quarantinedGauge.set(static_cast<int64_t>(failed));
+        active.set(0);
+        Metrics::writeFile(options.metricsPath);
+    }
+    std::cout << "Batch finished: " << queue.count("done") << " done, " << failed << " quarantined, "
+              << queue.count("pending") << " pending" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
+
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Image.h"
+#include <map>
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @brief Class implementing a crash-resilient work queue in a job directory
+ * @details The queue is a directory tree, so any number of processes on any number of
+ *          machines sharing the directory can drain it:
+ *          - pending/     inputs waiting to be processed ("name" or "name#attempts")
+ *          - claimed/     inputs being processed ("name#attempts@host.pid")
+ *          - done/        results, written under the input name
+ *          - quarantine/  inputs that failed more often than allowed
+ *
+ *          Every state change is a single rename(), which is atomic within one file
+ *          system, so an input is claimed by exactly one worker. Claims of a worker that
+ *          died stay in claimed/ until recover() puts them back with one more attempt.
+ *          Every claim is a lease: its coordinator renews the modification time while
+ *          the worker runs, so when a whole node dies any other coordinator can take
+ *          its claims back once they have not been renewed for the lease time.
+ */
+class BatchQueue {
+private:
+    std::string root;            ///< Job directory
+    std::string host;            ///< Host name used in claims
+    unsigned int maxRetries;     ///< Attempts allowed after the first one
+
+    /**
+     * @brief Splits a queue entry name into its parts
+     * @param entry Entry name
+     * @param base Receives the input name
+     * @param attempts Receives the number of failed attempts
+     * @param owner Receives "host.pid" of claims (empty for pending entries)
+     */
+    static void parse(const std::string& entry, std::string& base, unsigned int& attempts, std::string& owner);
+
+    /**
+     * @brief Returns a claimed entry to pending/ or moves it to quarantine/
+     * @param entry Claimed entry name
+     * @return true if the entry was quarantined
+     */
+    bool requeue(const std::string& entry);
+
+public:
+    /**
+     * @brief Constructor
+     * @param jobDir Job directory
+     * @param maxRetries Attempts allowed after the first one before an input is quarantined (default: 2)
+     */
+    BatchQueue(const std::string& jobDir, unsigned int maxRetries = 2);
+
+    /**
+     * @brief Creates the queue directories
+     * @return true if successful, false otherwise
+     */
+    bool prepare();
+
+    /**
+     * @brief Claims the next pending input for the calling process
+     * @param entry Receives the claimed entry name
+     * @return true if an input was claimed, false if none is pending
+     */
+    bool claim(std::string& entry);
+
+    /**
+     * @brief Gets the path of a claimed input
+     * @param entry Claimed entry name
+     * @return Path to read the input from
+     */
+    std::string claimedPath(const std::string& entry) const;
+
+    /**
+     * @brief Stores the result of a claimed input and removes the claim
+     * @param entry Claimed entry name
+     * @param result Processed image
+     * @return true if successful, false if the result could not be written
+     */
+    bool complete(const std::string& entry, Image& result);
+
+    /**
+     * @brief Gives up a claimed input after a failure
+     * @param entry Claimed entry name
+     * @return true if the input was quarantined, false if it will be retried
+     */
+    bool fail(const std::string& entry);
+
+    /**
+     * @brief Releases all claims of a dead process on this host
+     * @param pid Process ID
+     * @param quarantined Receives the number of inputs quarantined
+     * @return Number of claims released
+     */
+    unsigned int recover(pid_t pid, unsigned int& quarantined);
+
+    /**
+     * @brief Lists the claims of processes on this host
+     * @return Claimed entry names by process ID
+     */
+    std::map<pid_t, std::string> localClaims() const;
+
+    /**
+     * @brief Renews the lease of a claim
+     * @param entry Claimed entry name
+     * @return true if the claim still exists
+     */
+    bool renew(const std::string& entry);
+
+    /**
+     * @brief Releases claims whose owner is gone
+     * @param lease Seconds after which a claim that was not renewed is released, 0 to never expire claims
+     * @param quarantined Receives the number of inputs quarantined
+     * @return Number of claims released
+     * @details Releases claims of processes on this host that no longer exist and claims
+     *          of other hosts whose lease expired. Used at start-up to clean up after a
+     *          coordinator that was killed, and periodically to take over the claims of
+     *          nodes that died. Clocks of nodes sharing the job must agree to well within the lease
+     */
+    unsigned int recoverOrphans(unsigned int lease, unsigned int& quarantined);
+
+    /**
+     * @brief Counts the entries of a queue directory
+     * @param state "pending", "claimed", "done" or "quarantine"
+     * @return Number of entries
+     */
+    size_t count(const std::string& state) const;
+};
+
+/**
+ * @brief Structure holding the settings of a batch run
+ */
+struct BatchOptions {
+    std::string jobDir;               ///< Job directory with the pending/ inputs
+    unsigned int workers = 0;         ///< Worker processes (0: one per CPU)
+    unsigned int maxRetries = 2;      ///< Retries before an input is quarantined
+    std::string expression = "a";     ///< Pixel expression applied to every input
+    std::string metricsPath;          ///< Prometheus text file (empty: no metrics)
+    unsigned int timeout = 0;         ///< Seconds a worker may spend on one input before it is killed (0: no limit)
+    unsigned int lease = 60;          ///< Seconds after which claims that were not renewed are taken over (0: never)
+};
+
+/**
+ * @brief Namespace running a job directory with a pool of worker processes
+ */
+namespace BatchMode {
+    /**
+     * @brief Forks workers and supervises them until the queue is drained
+     * @param options Batch settings
+     * @return 0 if every input was processed, 1 if some were quarantined, 2 on setup errors
+     * @details Workers that die are restarted and their claimed inputs retried; an
+     *          input that keeps failing is quarantined instead of stopping the batch.
+     *          Workers exceeding the per-input timeout are killed and handled the same way
+     */
+    int run(const BatchOptions& options);
+}
@@ -0,0 +1,119 @@
+/**
+ * @file BatchQueueCheck.cpp
+ * @brief Checks that coordinators sharing a job directory never take over live claims
+ * @details Usage: BatchQueueCheck
+ *          A worker process of one coordinator claims an input whose mtime is an hour
+ *          old, and a second coordinator on the same job directory then releases
+ *          orphaned claims with a 60 s lease. The live claim must stay in claimed/ and
+ *          be renewed, a claim of another host moved in by a fresh rename must survive
+ *          too, and the worker's claim must be released only after the worker died.
+ *          Exits with 1 if any step fails. Registered with CTest.
+ */
+
+#include "BatchQueue.h"
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const unsigned int lease = 60;  ///< Lease of the second coordinator, in seconds
+
+/**
+ * @brief Writes a small input whose modification time lies an hour in the past
+ * @param path File path
+ * @return true if successful
+ */
+bool writeOldInput(const std::string& path) {
+    Image img(8, 8);
+    if (!img.save(path)) {
+        return false;
+    }
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = std::time(nullptr) - 3600;
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+    return utimensat(AT_FDCWD, path.c_str(), times, 0) == 0;
+}
+
+/**
+ * @brief Prints the outcome of one step
+ * @param name Step description
+ * @param ok true if the step passed
+ * @return ok
+ */
+bool expect(const std::string& name, bool ok) {
+    std::cout << (ok ? "ok      " : "FAILED  ") << name << "\n";
+    return ok;
+}
+
+}
+
+/**
+ * @brief Main function running the two-coordinator check
+ * @return 0 if all steps passed, 1 otherwise
+ */
+int main() {
+    std::string dir = (std::filesystem::temp_directory_path() /
+                       ("batch_queue_check_" + std::to_string(getpid()))).string();
+    BatchQueue first(dir);
+    if (!first.prepare() || !writeOldInput(dir + "/pending/input.pgm")) {
+        std::cerr << "Cannot set up job directory " << dir << std::endl;
+        return 1;
+    }
+
+    // Worker of the first coordinator: claims the input and holds it until killed
+    int ready[2];
+    if (pipe(ready) != 0) {
+        return 1;
+    }
+    std::cout.flush();
+    pid_t worker = fork();
+    if (worker == 0) {
+        std::string entry;
+        char claimed = first.claim(entry) ? 1 : 0;
+        if (write(ready[1], &claimed, 1) != 1) {
+            _exit(1);
+        }
+        pause();
+        _exit(0);
+    }
+    char claimed = 0;
+    if (worker < 0 || read(ready[0], &claimed, 1) != 1) {
+        return 1;
+    }
+
+    bool passed = expect("worker claimed the input", claimed == 1 && first.count("claimed") == 1);
+
+    std::string entry = first.localClaims()[worker];
+    struct stat st;
+    passed &= expect("claim renewed on rename",
+                     stat((dir + "/claimed/" + entry).c_str(), &st) == 0 && std::time(nullptr) - st.st_mtime < 60);
+
+    // Claim of another host with an old mtime, moved in just now
+    writeOldInput(dir + "/pending/remote.pgm");
+    std::rename((dir + "/pending/remote.pgm").c_str(), (dir + "/claimed/remote.pgm@otherhost.1").c_str());
+
+    BatchQueue second(dir);
+    unsigned int quarantined = 0;
+    unsigned int released = second.recoverOrphans(lease, quarantined);
+    passed &= expect("second coordinator keeps the live claim", released == 0 && first.count("claimed") == 2);
+    passed &= expect("nothing quarantined", first.count("quarantine") == 0 && first.count("pending") == 0);
+
+    kill(worker, SIGKILL);
+    waitpid(worker, nullptr, 0);
+    released = second.recoverOrphans(lease, quarantined);
+    passed &= expect("claim of the dead worker released", released == 1 && quarantined == 0 &&
+                     std::filesystem::exists(dir + "/pending/input.pgm#1"));
+    passed &= expect("claim of the other host kept", std::filesystem::exists(dir + "/claimed/remote.pgm@otherhost.1"));
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+#include "BlobDetection.h"
+#include "ImageBuffer.h"
+#include "Drawing.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+const unsigned int minOctaveSize = 16;  ///< Smallest octave width or height searched
+const double inputBlur = 0.5;           ///< Blur assumed to be present in the input
+
+/**
+ * @brief Converts an image into a float image with values in [0,1]
+ * @param img Source grayscale image
+ * @param dst Destination image of the same size
+ */
+void normalize(const Image& img, ImageF& dst) {
+    unsigned int width = img.width();
+    dst = ImageF(width, img.height());
+    Parallel::forRange(img.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned char* src = img.row(static_cast<int>(y));
+            float* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = src[x] * (1.0f / 255.0f);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Averages 2x2 blocks of a float image
+ * @param src Source image
+ * @param dst Destination image of half the width and height
+ * @details Octave pixel x covers input pixels [x * factor, (x + 1) * factor), so octave
+ *          coordinates convert to input coordinates the same way for every octave
+ */
+void halve(const ImageF& src, ImageF& dst) {
+    unsigned int width = src.width() / 2;
+    unsigned int height = src.height() / 2;
+    dst = ImageF(width, height);
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const float* top = src.row(2 * y);
+            const float* bottom = src.row(2 * y + 1);
+            float* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = 0.25f * (top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Blurs a float image with a separable Gaussian kernel
+ * @param src Source image
+ * @param dst Destination image of the same size
+ * @param sigma Standard deviation of the kernel
+ * @param temp Scratch image holding the horizontal pass
+ * @details The kernel radius is ceil(3 sigma); edges are replicated. The vertical pass
+ *          adds whole weighted rows, so both passes run over contiguous memory. Both
+ *          passes are split into row bands processed in parallel
+ */
+void blur(const ImageF& src, ImageF& dst, double sigma, ImageF& temp) {
+    unsigned int width = src.width();
+    unsigned int height = src.height();
+    int radius = std::max(1, static_cast<int>(std::ceil(3.0 * sigma)));
+
+    std::vector<float> kernel(2 * radius + 1);
+    double total = 0.0;
+    for (int i = -radius; i <= radius; ++i) {
+        total += kernel[i + radius] = static_cast<float>(std::exp(-0.5 * i * i / (sigma * sigma)));
+    }
+    for (float& k : kernel) {
+        k = static_cast<float>(k / total);
+    }
+
+    temp = ImageF(width, height);
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        std::vector<float> padded(width + 2 * radius);
+        for (unsigned int y = begin; y < end; ++y) {
+            const float* in = src.row(y);
+            std::fill(padded.begin(), padded.begin() + radius, in[0]);
+            std::copy(in, in + width, padded.begin() + radius);
+            std::fill(padded.begin() + radius + width, padded.end(), in[width - 1]);
+
+            float* out = temp.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                float sum = 0.0f;
+                for (int i = 0; i <= 2 * radius; ++i) {
+                    sum += kernel[i] * padded[x + i];
+                }
+                out[x] = sum;
+            }
+        }
+    });
+
+    dst = ImageF(width, height);
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            float* out = dst.row(y);
+            for (int i = -radius; i <= radius; ++i) {
+                int sy = std::min(std::max(static_cast<int>(y) + i, 0), static_cast<int>(height) - 1);
+                const float* in = temp.row(static_cast<unsigned int>(sy));
+                float k = kernel[i + radius];
+                for (unsigned int x = 0; x < width; ++x) {
+                    out[x] += k * in[x];
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Computes the scale-normalized Laplacian of a Gaussian level
+ * @param src Gaussian level
+ * @param dst Destination image, sigma^2 * (4-neighbour Laplacian)
+ * @param sigma Blur of the level
+ */
+void laplacian(const ImageF& src, ImageF& dst, double sigma) {
+    unsigned int width = src.width();
+    unsigned int height = src.height();
+    float norm = static_cast<float>(sigma * sigma);
+    dst = ImageF(width, height);
+
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const float* up = src.row(y > 0 ? y - 1 : y);
+            const float* mid = src.row(y);
+            const float* down = src.row(y + 1 < height ? y + 1 : y);
+            float* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                unsigned int left = x > 0 ? x - 1 : x;
+                unsigned int right = x + 1 < width ? x + 1 : x;
+                out[x] = norm * (up[x] + down[x] + mid[left] + mid[right] - 4.0f * mid[x]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Computes a difference of Gaussian levels normalized like the Laplacian
+ * @param lower Gaussian level with blur sigma
+ * @param upper Gaussian level with blur k * sigma
+ * @param dst Destination image, (upper - lower) / (k - 1)
+ * @param k Ratio of the blurs
+ */
+void difference(const ImageF& lower, const ImageF& upper, ImageF& dst, double k) {
+    unsigned int width = lower.width();
+    dst = ImageF(width, lower.height());
+    float norm = static_cast<float>(1.0 / (k - 1.0));
+    Parallel::forRange(lower.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const float* a = lower.row(y);
+            const float* b = upper.row(y);
+            float* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = norm * (b[x] - a[x]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Computes the vertex offset of a parabola through three samples
+ * @param a Sample at -1
+ * @param b Sample at 0
+ * @param c Sample at +1
+ * @return Offset of the extremum in [-0.5, 0.5]
+ */
+float vertex(float a, float b, float c) {
+    float curvature = a - 2.0f * b + c;
+    if (curvature == 0.0f) {
+        return 0.0f;
+    }
+    return std::min(0.5f, std::max(-0.5f, 0.5f * (a - c) / curvature));
+}
+
+/**
+ * @brief Finds the 26-neighbour extrema of the middle of three response levels
+ * @param below Response one level down
+ * @param level Response searched
+ * @param above Response one level up
+ * @param params Detection parameters
+ * @param sigma Blur of the searched level, in octave pixels
+ * @param k Blur ratio between levels
+ * @param factor Octave downsampling factor
+ * @param out Vector the keypoints are appended to
+ * @details For every row the largest and smallest neighbour of each sample is computed
+ *          in branch-free passes over contiguous arrays, which the compiler vectorizes;
+ *          only the few samples beating their neighbours reach the scalar tests. Rows are
+ *          searched in parallel bands and their keypoints appended in row order
+ */
+void findExtrema(const ImageF& below, const ImageF& level, const ImageF& above, const BlobParameters& params,
+                 double sigma, double k, unsigned int factor, std::vector<Keypoint>& out) {
+    unsigned int width = level.width();
+    unsigned int height = level.height();
+    float threshold = params.threshold;
+    float edgeLimit = (params.edgeRatio + 1.0f) * (params.edgeRatio + 1.0f) / std::max(params.edgeRatio, 1e-6f);
+
+    std::vector<std::vector<Keypoint>> found(height);
+
+    Parallel::forRange(height > 2 ? height - 2 : 0, [&](unsigned int begin, unsigned int end) {
+        std::vector<float> columnMax(width), columnMin(width), fullMax(width), fullMin(width);
+        for (unsigned int y = begin + 1; y < end + 1; ++y) {
+            const float* rows[8] = {below.row(y - 1), below.row(y), below.row(y + 1),
+                                    above.row(y - 1), above.row(y), above.row(y + 1),
+                                    level.row(y - 1), level.row(y + 1)};
+            const float* mid = level.row(y);
+
+            // Column extremes of the 8 samples above, below and beside the center row
+            for (unsigned int x = 0; x < width; ++x) {
+                float hi = rows[0][x];
+                float lo = rows[0][x];
+                for (int r = 1; r < 8; ++r) {
+                    hi = std::max(hi, rows[r][x]);
+                    lo = std::min(lo, rows[r][x]);
+                }
+                columnMax[x] = hi;
+                columnMin[x] = lo;
+                fullMax[x] = std::max(hi, mid[x]);
+                fullMin[x] = std::min(lo, mid[x]);
+            }
+
+            for (unsigned int x = 1; x + 1 < width; ++x) {
+                float v = mid[x];
+                float hi = std::max(std::max(fullMax[x - 1], fullMax[x + 1]), columnMax[x]);
+                float lo = std::min(std::min(fullMin[x - 1], fullMin[x + 1]), columnMin[x]);
+                if (!((v > hi && v > threshold) || (v < lo && v < -threshold))) {
+                    continue;
+                }
+
+                float dxx = mid[x - 1] - 2.0f * v + mid[x + 1];
+                float dyy = rows[6][x] - 2.0f * v + rows[7][x];
+                if (params.edgeRatio > 0.0f) {
+                    float dxy = 0.25f * (rows[7][x + 1] - rows[7][x - 1] - rows[6][x + 1] + rows[6][x - 1]);
+                    float trace = dxx + dyy;
+                    float det = dxx * dyy - dxy * dxy;
+                    if (det <= 0.0f || trace * trace >= edgeLimit * det) {
+                        continue; // Saddle or edge, not a blob
+                    }
+                }
+
+                float ox = vertex(mid[x - 1], v, mid[x + 1]);
+                float oy = vertex(rows[6][x], v, rows[7][x]);
+                float os = vertex(rows[1][x], v, rows[4][x]);
+
+                Keypoint keypoint;
+                keypoint.x = (x + ox + 0.5f) * factor - 0.5f;
+                keypoint.y = (y + oy + 0.5f) * factor - 0.5f;
+                keypoint.scale = static_cast<float>(sigma * std::pow(k, os) * factor);
+                keypoint.response = v;
+                found[y].push_back(keypoint);
+            }
+        }
+    });
+
+    for (const std::vector<Keypoint>& row : found) {
+        out.insert(out.end(), row.begin(), row.end());
+    }
+}
+
+/**
+ * @brief Detects the blobs of one octave
+ * @param gaussian First Gaussian level of the octave, blurred by params.sigma; overwritten
+ * @param factor Octave downsampling factor
+ * @param params Detection parameters
+ * @param out Vector the keypoints are appended to
+ * @param seed Receives level params.levels, blurred by 2 * params.sigma, which seeds the next octave
+ * @details Keeps only two Gaussian levels and three response levels alive: level i + 1
+ *          is blurred from level i by sigma_i * sqrt(k^2 - 1), the response of level i
+ *          is computed, and the middle of the last three responses is searched
+ */
+void detectOctave(ImageF& gaussian, unsigned int factor, const BlobParameters& params, std::vector<Keypoint>& out,
+                  ImageF& seed) {
+    unsigned int levels = std::max(1u, params.levels);
+    double k = std::pow(2.0, 1.0 / levels);
+
+    ImageF next, temp;
+    ImageF responses[3];
+    double sigma = params.sigma;
+    for (unsigned int i = 0; i < levels + 2; ++i) {
+        if (i == levels) {
+            seed = gaussian;
+        }
+        ImageF& response = responses[i % 3];
+        bool needNext = params.method == BlobParameters::Method::DoG || i + 1 < levels + 2;
+        if (needNext) {
+            blur(gaussian, next, sigma * std::sqrt(k * k - 1.0), temp);
+        }
+        if (params.method == BlobParameters::Method::DoG) {
+            difference(gaussian, next, response, k);
+        } else {
+            laplacian(gaussian, response, sigma);
+        }
+
+        if (i >= 2) {
+            findExtrema(responses[(i - 2) % 3], responses[(i - 1) % 3], response, params, sigma / k, k, factor, out);
+        }
+        if (needNext) {
+            std::swap(gaussian, next);
+        }
+        sigma *= k;
+    }
+}
+}
+
+namespace BlobDetection {
+
+/**
+ * @brief Detects blobs as extrema of a DoG or LoG scale space
+ * @param img Source grayscale image
+ * @param params Detection parameters
+ * @return Keypoints ordered by octave, level and position
+ * @details Responses approximate sigma^2 times the Laplacian of the Gaussian for both
+ *          methods (DoG is divided by k - 1), so the same threshold fits both. Octaves
+ *          depend on each other and run one after another; the work inside each octave
+ *          is split into row bands
+ */
+std::vector<Keypoint> detect(const Image& img, const BlobParameters& params) {
+    unsigned int octaves = 0;
+    while (octaves < params.octaves && octaves < 31 &&
+           (img.width() >> octaves) >= minOctaveSize && (img.height() >> octaves) >= minOctaveSize) {
+        ++octaves;
+    }
+
+    std::vector<Keypoint> keypoints;
+    if (octaves == 0) {
+        return keypoints;
+    }
+
+    ImageF base, gaussian, seed, temp;
+    normalize(img, base);
+    blur(base, gaussian, std::sqrt(std::max(params.sigma * params.sigma - inputBlur * inputBlur, 0.01)), temp);
+    for (unsigned int o = 0; o < octaves; ++o) {
+        detectOctave(gaussian, 1u << o, params, keypoints, seed);
+        if (o + 1 < octaves) {
+            halve(seed, gaussian); // Level 2 sigma becomes sigma at half the resolution
+        }
+    }
+    return keypoints;
+}
+
+/**
+ * @brief Draws keypoints as circles
+ * @param img Grayscale image to draw on
+ * @param keypoints Keypoints in img coordinates
+ * @param value Grayscale value to use for drawing
+ */
+void draw(Image& img, const std::vector<Keypoint>& keypoints, unsigned char value) {
+    for (const Keypoint& keypoint : keypoints) {
+        Point center(static_cast<int>(std::lround(keypoint.x)), static_cast<int>(std::lround(keypoint.y)));
+        int radius = std::max(1, static_cast<int>(std::lround(std::sqrt(2.0f) * keypoint.scale)));
+        Drawing::drawCircle(img, center, radius, value);
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Image.h"
+#include <vector>
+
+/**
+ * @brief Structure describing a detected blob
+ */
+struct Keypoint {
+    float x = 0.0f;         ///< Center X in input pixels (sub-pixel)
+    float y = 0.0f;         ///< Center Y in input pixels (sub-pixel)
+    float scale = 0.0f;     ///< Gaussian sigma in input pixels; the blob radius is about sqrt(2) * scale
+    float response = 0.0f;  ///< Scale-normalized Laplacian, negative for bright blobs, positive for dark ones
+};
+
+/**
+ * @brief Structure holding blob detection parameters
+ */
+struct BlobParameters {
+    /**
+     * @brief Scale-space operator
+     */
+    enum class Method {
+        DoG,  ///< Difference of adjacent Gaussian levels
+        LoG   ///< Scale-normalized Laplacian of each Gaussian level
+    };
+
+    Method method = Method::DoG;    ///< Operator
+    unsigned int octaves = 4;       ///< Maximum number of octaves (each halves the resolution)
+    unsigned int levels = 3;        ///< Scales searched per octave
+    double sigma = 1.6;             ///< Blur of the first level of every octave, in octave pixels
+    float threshold = 0.03f;        ///< Minimum |response| for gray values scaled to [0,1]
+    float edgeRatio = 10.0f;        ///< Maximum ratio of principal curvatures, 0 to keep edge responses
+};
+
+/**
+ * @brief Namespace containing scale-space blob detection
+ */
+namespace BlobDetection {
+    /**
+     * @brief Detects blobs as extrema of a DoG or LoG scale space
+     * @param img Source grayscale image
+     * @param params Detection parameters
+     * @return Keypoints ordered by octave, level and position
+     * @details Every octave after the first starts from the Gaussian level of twice the
+     *          base blur of the previous octave, averaged over 2x2 blocks, so no octave
+     *          re-blurs the input. Within an octave each Gaussian level is blurred from
+     *          the previous one with a small separable kernel. Blurs, responses and the
+     *          extremum search are split into row bands processed in parallel.
+     *          A sample is kept if it is larger or smaller than all 26 neighbours in
+     *          position and scale, exceeds the threshold and passes the edge test.
+     *          Positions and scales are refined with a parabola through the neighbours
+     */
+    std::vector<Keypoint> detect(const Image& img, const BlobParameters& params = BlobParameters());
+
+    /**
+     * @brief Draws keypoints as circles
+     * @param img Grayscale image to draw on
+     * @param keypoints Keypoints in img coordinates
+     * @param value Grayscale value to use for drawing (default: 255)
+     * @details Circle radii are sqrt(2) * scale, the radius at which the Laplacian of a disc peaks
+     */
+    void draw(Image& img, const std::vector<Keypoint>& keypoints, unsigned char value = 255);
+}
@@ -0,0 +1,322 @@
+#include "Catalog.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+const char* const catalogHeader = "# imageprocessing catalog v1";   ///< First line of every catalog file
+const size_t scanChunk = 1 << 20;                                   ///< Bytes read per call while hashing
+const uint64_t fnvOffset = 0xcbf29ce484222325ull;                   ///< FNV-1a 64-bit offset basis
+const uint64_t fnvPrime = 0x100000001b3ull;                         ///< FNV-1a 64-bit prime
+
+/**
+ * @brief Reads size and modification time of a file
+ * @param path Path of the file
+ * @param mtime Receives the modification time in nanoseconds
+ * @param size Receives the file size in bytes
+ * @return true if the file is a regular file
+ */
+bool fileStatus(const std::string& path, long long& mtime, unsigned long long& size) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    mtime = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    size = static_cast<unsigned long long>(st.st_size);
+    return true;
+}
+
+/**
+ * @brief Makes a path absolute and normalized
+ * @param path Relative or absolute path
+ * @return Absolute path without "." or ".." components or a trailing separator
+ * @details Gives every file one key, however the tree was named when it was cataloged
+ */
+std::string absolutePath(const std::string& path) {
+    std::error_code ec;
+    std::string result = fs::absolute(path, ec).lexically_normal().string();
+    while (result.size() > 1 && result.back() == '/') {
+        result.pop_back();
+    }
+    return result;
+}
+
+/**
+ * @brief Checks if a path lies inside a directory
+ * @param path Absolute normalized path
+ * @param dir Absolute normalized directory without trailing separator
+ * @return true if path is dir or below it
+ */
+bool isInside(const std::string& path, const std::string& dir) {
+    if (dir == "/") {
+        return !path.empty() && path[0] == '/';
+    }
+    return path.compare(0, dir.size(), dir) == 0 && (path.size() == dir.size() || path[dir.size()] == '/');
+}
+}
+
+/**
+ * @brief Constructor
+ * @param catalogPath File the catalog is stored in
+ */
+ImageCatalog::ImageCatalog(const std::string& catalogPath) : catalogPath(catalogPath) {}
+
+/**
+ * @brief Reads a file once, computing its hash and optionally its histogram
+ * @param entry Record with path and header filled in; receives hash and histogram
+ * @param histogram true to count the gray values of the raster
+ * @return true if the file was read completely
+ * @details The histogram is counted on the same chunks as the hash, so the file is read
+ *          only once. Only 8-bit binary rasters get a histogram
+ */
+bool ImageCatalog::scan(CatalogEntry& entry, bool histogram) {
+    int fd = open(entry.path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool count = histogram && entry.info.format == "P5" && entry.info.maxValue <= 255;
+    unsigned long long rasterEnd = entry.info.dataOffset +
+        static_cast<unsigned long long>(entry.info.width) * entry.info.height;
+    entry.histogram.fill(0);
+
+    std::vector<unsigned char> buffer(scanChunk);
+    uint64_t hash = fnvOffset;
+    unsigned long long offset = 0;
+    while (true) {
+        ssize_t got = read(fd, buffer.data(), buffer.size());
+        if (got < 0) {
+            close(fd);
+            return false;
+        }
+        if (got == 0) {
+            break;
+        }
+
+        for (ssize_t i = 0; i < got; ++i) {
+            hash = (hash ^ buffer[i]) * fnvPrime;
+        }
+
+        if (count) {
+            unsigned long long begin = std::max<unsigned long long>(offset, entry.info.dataOffset);
+            unsigned long long end = std::min<unsigned long long>(offset + got, rasterEnd);
+            for (unsigned long long i = begin; i < end; ++i) {
+                ++entry.histogram[buffer[i - offset]];
+            }
+        }
+        offset += got;
+    }
+    close(fd);
+
+    entry.hash = hash;
+    entry.hasHistogram = count && offset >= rasterEnd; // Truncated rasters get no histogram
+    return true;
+}
+
+/**
+ * @brief Reads the catalog file
+ * @return true if successful or the file does not exist yet, false if it is malformed
+ */
+bool ImageCatalog::load() {
+    entries.clear();
+    std::ifstream file(catalogPath);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != catalogHeader) {
+        return false;
+    }
+
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            entries.clear();
+            return false;
+        }
+
+        CatalogEntry entry;
+        entry.path = line.substr(0, tab);
+        std::istringstream fields(line.substr(tab + 1));
+        std::string histogram;
+        fields >> entry.info.format >> entry.info.width >> entry.info.height >> entry.info.maxValue
+               >> entry.info.dataOffset >> entry.mtime >> entry.size >> std::hex >> entry.hash >> std::dec >> histogram;
+        if (!fields) {
+            entries.clear();
+            return false;
+        }
+
+        if (histogram != "-") {
+            std::istringstream counts(histogram);
+            for (unsigned long long& c : entry.histogram) {
+                char comma;
+                if (!(counts >> c) || (&c != &entry.histogram.back() && !(counts >> comma))) {
+                    entries.clear();
+                    return false;
+                }
+            }
+            entry.hasHistogram = true;
+        }
+        entries[entry.path] = entry;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the catalog file
+ * @return true if successful, false otherwise
+ */
+bool ImageCatalog::save() const {
+    std::string temp = catalogPath + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream file(temp);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        file << catalogHeader << '\n';
+        for (const auto& item : entries) {
+            const CatalogEntry& e = item.second;
+            file << e.path << '\t' << e.info.format << '\t' << e.info.width << '\t' << e.info.height << '\t'
+                 << e.info.maxValue << '\t' << e.info.dataOffset << '\t' << e.mtime << '\t' << e.size << '\t'
+                 << std::hex << e.hash << std::dec << '\t';
+            if (e.hasHistogram) {
+                for (size_t i = 0; i < e.histogram.size(); ++i) {
+                    file << (i ? "," : "") << e.histogram[i];
+                }
+            } else {
+                file << '-';
+            }
+            file << '\n';
+        }
+        if (!file) {
+            file.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temp.c_str(), catalogPath.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Brings the catalog up to date with a directory tree
+ * @param root Directory searched recursively for .pgm files
+ * @param histograms true to store histograms of new and changed files
+ * @return Counts of unchanged, updated, removed and invalid files, and the walk error if any
+ * @details A file is re-read only if its size or modification time differs from the
+ *          record, or a histogram is requested and the record has none. Headers are
+ *          probed while walking the tree; the full reads for hashing run in parallel.
+ *          Paths are stored absolute, so entries below root are pruned however root is spelled.
+ *          Entries are only pruned after a complete walk: an error would otherwise make every
+ *          file not reached yet look deleted
+ */
+CatalogRefresh ImageCatalog::refresh(const std::string& root, bool histograms) {
+    CatalogRefresh stats;
+    std::string dir = absolutePath(root);
+
+    std::vector<CatalogEntry> changed;
+    std::set<std::string> seen;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".pgm") {
+            continue;
+        }
+        std::string path = absolutePath(it->path().string());
+        if (path.find_first_of("\t\n") != std::string::npos) {
+            continue; // Cannot be stored in the catalog format
+        }
+
+        CatalogEntry entry;
+        entry.path = path;
+        if (!fileStatus(path, entry.mtime, entry.size)) {
+            continue;
+        }
+        ++stats.scanned;
+        seen.insert(path);
+
+        auto known = entries.find(path);
+        if (known != entries.end() && known->second.mtime == entry.mtime && known->second.size == entry.size &&
+            (!histograms || known->second.hasHistogram || known->second.info.format != "P5")) {
+            ++stats.unchanged;
+            continue;
+        }
+
+        if (!Image::probe(path, entry.info)) {
+            ++stats.invalid;
+            seen.erase(path);
+            continue;
+        }
+        changed.push_back(entry);
+    }
+    stats.error = ec;
+
+    std::vector<char> ok(changed.size(), 0);
+    Parallel::forRange(static_cast<unsigned int>(changed.size()), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i) {
+            ok[i] = scan(changed[i], histograms);
+        }
+    }, 1);
+
+    for (size_t i = 0; i < changed.size(); ++i) {
+        if (ok[i]) {
+            entries[changed[i].path] = changed[i];
+            ++stats.updated;
+        } else {
+            ++stats.invalid;
+            seen.erase(changed[i].path);
+        }
+    }
+
+    for (auto it = entries.begin(); it != entries.end() && !stats.error;) {
+        if (isInside(it->first, dir) && !seen.count(it->first)) {
+            it = entries.erase(it);
+            ++stats.removed;
+        } else {
+            ++it;
+        }
+    }
+    return stats;
+}
+
+/**
+ * @brief Selects records by a predicate
+ * @param predicate Function returning true for the records to keep
+ * @return Matching records, ordered by path
+ */
+std::vector<const CatalogEntry*> ImageCatalog::query(const std::function<bool(const CatalogEntry&)>& predicate) const {
+    std::vector<const CatalogEntry*> result;
+    for (const auto& item : entries) {
+        if (predicate(item.second)) {
+            result.push_back(&item.second);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Finds the record of a file
+ * @param path Relative or absolute path of the file
+ * @return Record, or nullptr if the file is not cataloged
+ */
+const CatalogEntry* ImageCatalog::find(const std::string& path) const {
+    auto it = entries.find(absolutePath(path));
+    return it == entries.end() ? nullptr : &it->second;
+}
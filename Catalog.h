@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Image.h"
+#include "Histogram.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/**
+ * @brief Structure holding the catalog record of one image file
+ */
+struct CatalogEntry {
+    std::string path;                   ///< Absolute normalized path of the file
+    PGMInfo info;                       ///< Header fields
+    long long mtime = 0;                ///< Modification time in nanoseconds since the epoch
+    unsigned long long size = 0;        ///< File size in bytes
+    uint64_t hash = 0;                  ///< FNV-1a 64-bit hash of the whole file
+    bool hasHistogram = false;          ///< true if histogram is valid
+    Histogram::Counts histogram = {};   ///< Gray value counts of the raster (P5 files only)
+};
+
+/**
+ * @brief Structure holding the outcome of a catalog refresh
+ */
+struct CatalogRefresh {
+    size_t scanned = 0;     ///< PGM files found under the root
+    size_t unchanged = 0;   ///< Files whose size and modification time matched the catalog
+    size_t updated = 0;     ///< Files added or re-read
+    size_t removed = 0;     ///< Entries of files that no longer exist
+    size_t invalid = 0;     ///< Files with a .pgm extension but no valid header
+    std::error_code error;  ///< Error that ended the walk early; nothing was removed if set
+};
+
+/**
+ * @brief Class maintaining a persistent catalog of PGM metadata for a directory tree
+ * @details The catalog stores the header of every image together with its modification
+ *          time, size, content hash and optionally its histogram, so images can be
+ *          selected by their properties without reading any raster. refresh() only
+ *          re-reads files whose size or modification time changed since the last run.
+ *
+ *          The catalog file is tab separated text with one image per line:
+ *          absolute path, format, width, height, maxval, data offset, mtime, size, hash (hex) and
+ *          the 256 histogram counts separated by commas, or "-" if there is none.
+ */
+class ImageCatalog {
+private:
+    std::string catalogPath;                        ///< File the catalog is stored in
+    std::map<std::string, CatalogEntry> entries;    ///< Records by path
+
+    /**
+     * @brief Reads a file once, computing its hash and optionally its histogram
+     * @param entry Record with path and header filled in; receives hash and histogram
+     * @param histogram true to count the gray values of the raster
+     * @return true if the file was read completely
+     */
+    static bool scan(CatalogEntry& entry, bool histogram);
+
+public:
+    /**
+     * @brief Constructor
+     * @param catalogPath File the catalog is stored in
+     */
+    ImageCatalog(const std::string& catalogPath);
+
+    /**
+     * @brief Reads the catalog file
+     * @return true if successful or the file does not exist yet, false if it is malformed
+     */
+    bool load();
+
+    /**
+     * @brief Writes the catalog file
+     * @return true if successful, false otherwise
+     * @details Writes a temporary file named after the process and renames it over the
+     *          catalog, so readers never see a partial catalog and concurrent writers do
+     *          not write into each other's temporary file
+     */
+    bool save() const;
+
+    /**
+     * @brief Brings the catalog up to date with a directory tree
+     * @param root Directory searched recursively for .pgm files
+     * @param histograms true to store histograms of new and changed files
+     * @return Counts of unchanged, updated, removed and invalid files, and the walk error if any
+     * @details Entries outside root are kept. Changed files are hashed in parallel. If the
+     *          walk fails (missing root, I/O error, a directory removed meanwhile) the files
+     *          found are still updated, but no entry is removed
+     */
+    CatalogRefresh refresh(const std::string& root, bool histograms = false);
+
+    /**
+     * @brief Selects records by a predicate
+     * @param predicate Function returning true for the records to keep
+     * @return Matching records, ordered by path
+     */
+    std::vector<const CatalogEntry*> query(const std::function<bool(const CatalogEntry&)>& predicate) const;
+
+    /**
+     * @brief Finds the record of a file
+     * @param path Relative or absolute path of the file
+     * @return Record, or nullptr if the file is not cataloged
+     */
+    const CatalogEntry* find(const std::string& path) const;
+
+    /**
+     * @brief Gets the number of records
+     * @return Number of cataloged images
+     */
+    size_t size() const { return entries.size(); }
+};
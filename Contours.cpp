@@ -0,0 +1,362 @@
+#include "Contours.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+const int rowStep[8] = {0, 1, 1, 1, 0, -1, -1, -1}; ///< Neighbour offsets clockwise on screen,
+const int colStep[8] = {1, 1, 0, -1, -1, -1, 0, 1}; ///< starting east (y grows downwards)
+
+/**
+ * @brief Gets the direction index of a neighbour
+ * @param di Row offset (-1..1)
+ * @param dj Column offset (-1..1)
+ * @return Index into rowStep/colStep
+ */
+int directionOf(int di, int dj) {
+    for (int d = 0; d < 8; ++d) {
+        if (rowStep[d] == di && colStep[d] == dj) {
+            return d;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Squared distance of a point from the line through a and b
+ * @param p Point
+ * @param a First point of the line
+ * @param b Second point of the line
+ * @return Squared distance (distance to a if a == b)
+ */
+double lineDistanceSquared(const Point& p, const Point& a, const Point& b) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double px = p.x - a.x, py = p.y - a.y;
+    double len2 = dx * dx + dy * dy;
+    if (len2 == 0) {
+        return px * px + py * py;
+    }
+    double cross = dx * py - dy * px;
+    return cross * cross / len2;
+}
+
+/**
+ * @brief Ramer-Douglas-Peucker on an open range, marking the points to keep
+ * @param pts Points
+ * @param first Index of the first point (kept)
+ * @param last Index of the last point (kept)
+ * @param eps2 Squared tolerance
+ * @param keep Flags set for the kept points
+ * @details Uses an explicit stack so long contours cannot overflow the call stack
+ */
+void markDouglasPeucker(const Point* pts, size_t first, size_t last, double eps2, std::vector<char>& keep) {
+    std::vector<std::pair<size_t, size_t>> stack{{first, last}};
+    keep[first] = keep[last] = 1;
+
+    while (!stack.empty()) {
+        std::pair<size_t, size_t> range = stack.back();
+        stack.pop_back();
+
+        double best = -1;
+        size_t index = range.first;
+        for (size_t i = range.first + 1; i < range.second; ++i) {
+            double d = lineDistanceSquared(pts[i], pts[range.first], pts[range.second]);
+            if (d > best) {
+                best = d;
+                index = i;
+            }
+        }
+        if (best > eps2) { // Farthest point is too far away, split there
+            keep[index] = 1;
+            stack.push_back({range.first, index});
+            stack.push_back({index, range.second});
+        }
+    }
+}
+
+/**
+ * @brief Cross product of (a - o) and (b - o)
+ * @return Positive for a counterclockwise turn in mathematical orientation
+ */
+long long cross(const Point& o, const Point& a, const Point& b) {
+    return static_cast<long long>(a.x - o.x) * (b.y - o.y) - static_cast<long long>(a.y - o.y) * (b.x - o.x);
+}
+
+}
+
+namespace Contours {
+
+/**
+ * @brief Extracts all contours of a binary image
+ * @param binary Image where every non-zero pixel is foreground
+ * @return Contours with hierarchy
+ * @details Suzuki & Abe (1985), "Topological structural analysis of digitized binary images
+ *          by border following". The image is copied into a zero-padded label array; each
+ *          border found in raster order gets the number NBD, written into the label array
+ *          while it is followed (negative where the pixel to the right is background).
+ *          LNBD, the last border number seen on the row, gives the parent contour.
+ *          Every pixel is visited a bounded number of times, so the run time is linear.
+ */
+ContourSet find(const Image& binary) {
+    ContourSet result;
+    unsigned int width = binary.width();
+    unsigned int height = binary.height();
+    result.offsets.push_back(0);
+    if (width == 0 || height == 0) {
+        return result;
+    }
+
+    int W = static_cast<int>(width) + 2; // One pixel background frame on all sides
+    int H = static_cast<int>(height) + 2;
+    std::vector<int> f(static_cast<size_t>(W) * H, 0);
+    for (unsigned int y = 0; y < height; ++y) {
+        const unsigned char* in = binary.row(y);
+        int* out = &f[static_cast<size_t>(y + 1) * W + 1];
+        for (unsigned int x = 0; x < width; ++x) {
+            out[x] = in[x] != 0 ? 1 : 0;
+        }
+    }
+
+    auto at = [&](int i, int j) -> int& { return f[static_cast<size_t>(i) * W + j]; };
+    int nbd = 1; // 1 is the frame
+
+    for (int i = 1; i < H - 1; ++i) {
+        int lnbd = 1;
+        for (int j = 1; j < W - 1; ++j) {
+            int fij = at(i, j);
+            if (fij == 0) {
+                continue;
+            }
+
+            bool outer = fij == 1 && at(i, j - 1) == 0;
+            bool hole = !outer && fij >= 1 && at(i, j + 1) == 0;
+
+            if (outer || hole) {
+                ++nbd;
+                int i2 = i, j2 = outer ? j - 1 : j + 1;
+                if (hole && fij > 1) {
+                    lnbd = fij;
+                }
+
+                // Parent from the type of the border we are inside of (frame counts as a hole)
+                bool lnbdHole = lnbd == 1 ? true : static_cast<bool>(result.isHole[lnbd - 2]);
+                int lnbdIndex = lnbd == 1 ? -1 : lnbd - 2;
+                int lnbdParent = lnbd == 1 ? -1 : result.parent[lnbd - 2];
+                result.parent.push_back(outer == lnbdHole ? lnbdIndex : lnbdParent);
+                result.isHole.push_back(hole);
+
+                // 3.1: clockwise from (i2,j2) for the first foreground neighbour
+                int d2 = directionOf(i2 - i, j2 - j);
+                int d1 = -1;
+                for (int k = 0; k < 8; ++k) {
+                    int d = (d2 + k) % 8;
+                    if (at(i + rowStep[d], j + colStep[d]) != 0) {
+                        d1 = d;
+                        break;
+                    }
+                }
+
+                if (d1 < 0) { // Isolated pixel
+                    at(i, j) = -nbd;
+                    result.points.push_back(Point(j - 1, i - 1));
+                } else {
+                    int i1 = i + rowStep[d1], j1 = j + colStep[d1];
+                    i2 = i1; j2 = j1;
+                    int i3 = i, j3 = j;
+
+                    while (true) {
+                        // 3.3: counterclockwise around (i3,j3), starting after (i2,j2)
+                        int d = directionOf(i2 - i3, j2 - j3);
+                        bool eastZero = false;
+                        int i4 = i3, j4 = j3;
+                        for (int k = 1; k <= 8; ++k) {
+                            int dd = (d - k + 8) % 8;
+                            int ni = i3 + rowStep[dd], nj = j3 + colStep[dd];
+                            if (at(ni, nj) != 0) {
+                                i4 = ni; j4 = nj;
+                                break;
+                            }
+                            if (dd == 0) {
+                                eastZero = true;
+                            }
+                        }
+
+                        // 3.4: label the border pixel
+                        if (eastZero) {
+                            at(i3, j3) = -nbd;
+                        } else if (at(i3, j3) == 1) {
+                            at(i3, j3) = nbd;
+                        }
+                        result.points.push_back(Point(j3 - 1, i3 - 1));
+
+                        // 3.5: back at the start, going the same way
+                        if (i4 == i && j4 == j && i3 == i1 && j3 == j1) {
+                            break;
+                        }
+                        i2 = i3; j2 = j3;
+                        i3 = i4; j3 = j4;
+                    }
+                }
+                result.offsets.push_back(result.points.size());
+            }
+
+            // 4: remember the last border crossed on this row
+            if (at(i, j) != 1) {
+                lnbd = std::abs(at(i, j));
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Simplifies a polyline with the Ramer-Douglas-Peucker algorithm
+ * @param pts Points of the polyline
+ * @param count Number of points
+ * @param epsilon Maximum distance of removed points
+ * @param closed true if the polyline is a closed contour
+ * @param out Vector the simplified points are appended to
+ * @details Closed contours are split at the point farthest from the first one and
+ *          both halves are simplified separately
+ */
+void simplify(const Point* pts, size_t count, double epsilon, bool closed, std::vector<Point>& out) {
+    if (count < 3) {
+        out.insert(out.end(), pts, pts + count);
+        return;
+    }
+
+    std::vector<char> keep(count + 1, 0);
+    double eps2 = epsilon * epsilon;
+
+    if (closed) {
+        size_t far = 0;
+        double best = -1;
+        for (size_t i = 1; i < count; ++i) {
+            double dx = pts[i].x - pts[0].x, dy = pts[i].y - pts[0].y;
+            if (dx * dx + dy * dy > best) {
+                best = dx * dx + dy * dy;
+                far = i;
+            }
+        }
+        if (far == 0) { // All points coincide
+            out.push_back(pts[0]);
+            return;
+        }
+
+        // Second half runs from far back to the first point, appended as index count
+        std::vector<Point> ring(pts, pts + count);
+        ring.push_back(pts[0]);
+        markDouglasPeucker(ring.data(), 0, far, eps2, keep);
+        markDouglasPeucker(ring.data(), far, count, eps2, keep);
+        for (size_t i = 0; i < count; ++i) {
+            if (keep[i]) {
+                out.push_back(pts[i]);
+            }
+        }
+        return;
+    }
+
+    markDouglasPeucker(pts, 0, count - 1, eps2, keep);
+    for (size_t i = 0; i < count; ++i) {
+        if (keep[i]) {
+            out.push_back(pts[i]);
+        }
+    }
+}
+
+/**
+ * @brief Computes the convex hull of a point set
+ * @param pts Points
+ * @param count Number of points
+ * @param out Vector the hull points are appended to, clockwise on screen (counterclockwise with y up)
+ * @details Andrew's monotone chain, O(n log n). Collinear points are dropped
+ */
+void convexHull(const Point* pts, size_t count, std::vector<Point>& out) {
+    std::vector<Point> sorted(pts, pts + count);
+    std::sort(sorted.begin(), sorted.end(), [](const Point& a, const Point& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const Point& a, const Point& b) {
+        return a.x == b.x && a.y == b.y;
+    }), sorted.end());
+
+    if (sorted.size() < 3) {
+        out.insert(out.end(), sorted.begin(), sorted.end());
+        return;
+    }
+
+    std::vector<Point> hull(2 * sorted.size());
+    size_t k = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) { // Lower hull
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) {
+            --k;
+        }
+        hull[k++] = sorted[i];
+    }
+    for (size_t i = sorted.size() - 1, lower = k + 1; i > 0; --i) { // Upper hull
+        while (k >= lower && cross(hull[k - 2], hull[k - 1], sorted[i - 1]) <= 0) {
+            --k;
+        }
+        hull[k++] = sorted[i - 1];
+    }
+    out.insert(out.end(), hull.begin(), hull.begin() + (k - 1)); // Last point repeats the first
+}
+
+/**
+ * @brief Computes the area enclosed by a closed polygon
+ * @param pts Polygon vertices
+ * @param count Number of vertices
+ * @return Absolute area
+ */
+double area(const Point* pts, size_t count) {
+    long long twice = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Point& a = pts[i];
+        const Point& b = pts[(i + 1) % count];
+        twice += static_cast<long long>(a.x) * b.y - static_cast<long long>(b.x) * a.y;
+    }
+    return std::llabs(twice) / 2.0;
+}
+
+/**
+ * @brief Computes the length of a polyline
+ * @param pts Points of the polyline
+ * @param count Number of points
+ * @param closed true to include the closing segment
+ * @return Length in pixels
+ */
+double perimeter(const Point* pts, size_t count, bool closed) {
+    double length = 0;
+    for (size_t i = 1; i < count; ++i) {
+        length += std::hypot(pts[i].x - pts[i - 1].x, pts[i].y - pts[i - 1].y);
+    }
+    if (closed && count > 1) {
+        length += std::hypot(pts[0].x - pts[count - 1].x, pts[0].y - pts[count - 1].y);
+    }
+    return length;
+}
+
+/**
+ * @brief Computes the bounding rectangle of a point set
+ * @param pts Points
+ * @param count Number of points
+ * @return Smallest rectangle containing all points (empty rectangle for no points)
+ */
+Rectangle boundingRect(const Point* pts, size_t count) {
+    if (count == 0) {
+        return Rectangle();
+    }
+
+    int minX = pts[0].x, maxX = pts[0].x, minY = pts[0].y, maxY = pts[0].y;
+    for (size_t i = 1; i < count; ++i) {
+        minX = std::min(minX, pts[i].x);
+        maxX = std::max(maxX, pts[i].x);
+        minY = std::min(minY, pts[i].y);
+        maxY = std::max(maxY, pts[i].y);
+    }
+    return Rectangle(minX, minY, maxX - minX + 1, maxY - minY + 1);
+}
+
+}
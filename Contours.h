@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Image.h"
+#include "Point.h"
+#include "Rectangle.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Structure holding all contours of a binary image
+ * @details The points of every contour are stored back to back in one vector, so
+ *          extraction does not allocate per contour. Contour k consists of
+ *          points[offsets[k]] .. points[offsets[k+1] - 1].
+ */
+struct ContourSet {
+    std::vector<Point> points;          ///< Points of all contours, in tracing order
+    std::vector<size_t> offsets;        ///< Start of each contour in points, plus points.size() at the end
+    std::vector<int> parent;            ///< Index of the enclosing contour, -1 for top-level contours
+    std::vector<bool> isHole;           ///< true for hole borders, false for outer borders
+
+    /**
+     * @brief Gets the number of contours
+     * @return Number of contours
+     */
+    size_t size() const { return parent.size(); }
+
+    /**
+     * @brief Gets the first point of a contour
+     * @param k Contour index
+     * @return Pointer to the first point
+     */
+    const Point* contour(size_t k) const { return points.data() + offsets[k]; }
+
+    /**
+     * @brief Gets the number of points of a contour
+     * @param k Contour index
+     * @return Number of points
+     */
+    size_t length(size_t k) const { return offsets[k + 1] - offsets[k]; }
+};
+
+/**
+ * @brief Namespace containing contour extraction and polygon utilities
+ */
+namespace Contours {
+    /**
+     * @brief Extracts all contours of a binary image with the Suzuki-Abe border following algorithm
+     * @param binary Image where every non-zero pixel is foreground
+     * @return Outer and hole borders with their hierarchy, 8-connected
+     */
+    ContourSet find(const Image& binary);
+
+    /**
+     * @brief Simplifies a polyline with the Ramer-Douglas-Peucker algorithm
+     * @param pts Points of the polyline
+     * @param count Number of points
+     * @param epsilon Maximum distance of removed points from the simplified polyline
+     * @param closed true if the polyline is a closed contour
+     * @param out Vector the simplified points are appended to
+     */
+    void simplify(const Point* pts, size_t count, double epsilon, bool closed, std::vector<Point>& out);
+
+    /**
+     * @brief Computes the convex hull of a point set (Andrew's monotone chain)
+     * @param pts Points
+     * @param count Number of points
+     * @param out Vector the hull points are appended to, clockwise on screen
+     *            (counterclockwise with y up), starting at the leftmost point
+     */
+    void convexHull(const Point* pts, size_t count, std::vector<Point>& out);
+
+    /**
+     * @brief Computes the area enclosed by a closed polygon (shoelace formula)
+     * @param pts Polygon vertices
+     * @param count Number of vertices
+     * @return Absolute area in square pixels
+     */
+    double area(const Point* pts, size_t count);
+
+    /**
+     * @brief Computes the length of a polyline
+     * @param pts Points of the polyline
+     * @param count Number of points
+     * @param closed true to include the segment from the last to the first point
+     * @return Length in pixels
+     */
+    double perimeter(const Point* pts, size_t count, bool closed = true);
+
+    /**
+     * @brief Computes the bounding rectangle of a point set
+     * @param pts Points
+     * @param count Number of points
+     * @return Smallest rectangle containing all points (pixels inclusive)
+     */
+    Rectangle boundingRect(const Point* pts, size_t count);
+}
@@ -0,0 +1,339 @@
+/**
+ * @file DifferentialCheck.cpp
+ * @brief Randomized differential checker comparing optimized operators with their references
+ * @details Usage: DifferentialCheck [iterations] [seed]
+ *          Every check runs the optimized operator and its reference (see Reference.h,
+ *          and the plain Image operators) on random inputs: sizes from 1x1 upwards, odd
+ *          widths, regions cut out of larger images, and kernels larger than the image.
+ *          Each check has a tolerance: 0 for exact operators, 1 LSB where the fast path
+ *          uses fixed point or single precision or the reference sums in another order.
+ *          Exits with 1 if any check fails. Temporary files carry the process ID, so
+ *          several runs can share a temporary directory. Registered with CTest.
+ */
+
+#include "Dithering.h"
+#include "Histogram.h"
+#include "ImageBatch.h"
+#include "ImageProcessing.h"
+#include "Mosaic.h"
+#include "PixelExpression.h"
+#include "Random.h"
+#include "Reference.h"
+#include "Remap.h"
+#include "Synthetic.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Structure holding the outcome of one check
+ */
+struct CheckResult {
+    std::string name;       ///< Operator being checked
+    int tolerance = 0;      ///< Largest allowed pixel difference
+    int maxDifference = 0;  ///< Largest difference seen
+    unsigned int cases = 0; ///< Number of inputs tried
+    unsigned int failures = 0; ///< Number of inputs outside the tolerance
+    std::string firstFailure;  ///< Description of the first failing input
+
+    /**
+     * @brief Constructor
+     * @param name Operator being checked
+     * @param tolerance Largest allowed pixel difference
+     */
+    CheckResult(const std::string& name, int tolerance) : name(name), tolerance(tolerance) {}
+};
+
+/**
+ * @brief Computes the largest pixel difference of two images
+ * @param a First image
+ * @param b Second image
+ * @return Largest absolute difference, 256 if the sizes differ
+ */
+int maxDifference(const Image& a, const Image& b) {
+    if (a.width() != b.width() || a.height() != b.height()) {
+        return 256;
+    }
+    int diff = 0;
+    for (unsigned int y = 0; y < a.height(); ++y) {
+        for (unsigned int x = 0; x < a.width(); ++x) {
+            diff = std::max(diff, std::abs(a.at(x, y) - b.at(x, y)));
+        }
+    }
+    return diff;
+}
+
+/**
+ * @brief Reads a whole file
+ * @param path File path
+ * @return File contents, empty if the file cannot be read
+ */
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Records the comparison of one input
+ * @param result Check to update
+ * @param diff Difference found
+ * @param input Description of the input
+ */
+void record(CheckResult& result, int diff, const std::string& input) {
+    ++result.cases;
+    result.maxDifference = std::max(result.maxDifference, diff);
+    if (diff > result.tolerance) {
+        if (result.failures++ == 0) {
+            result.firstFailure = input + ", difference " + std::to_string(diff);
+        }
+    }
+}
+
+/**
+ * @brief Creates a random test image
+ * @param rng Random generator
+ * @param description Receives a description of the image
+ * @return Image with random size and content, possibly a region of a larger image
+ */
+Image randomImage(Random::Generator& rng, std::string& description) {
+    static const unsigned int sizes[] = {1, 2, 3, 5, 7, 16, 31, 64, 67, 131, 257};
+    const unsigned int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    unsigned int width = sizes[rng.below(sizeCount)];
+    unsigned int height = sizes[rng.below(sizeCount)];
+    bool roi = rng.below(2) == 1;
+
+    SyntheticSpec spec;
+    spec.pattern = static_cast<SyntheticSpec::Pattern>(rng.below(5));
+    spec.width = roi ? width + 1 + rng.below(40) : width;
+    spec.height = roi ? height + 1 + rng.below(40) : height;
+    spec.seed = rng.next();
+    spec.cellSize = 1 + rng.below(40);
+    spec.angle = rng.uniform(0.0, 360.0);
+    Image img = Synthetic::generate(spec);
+
+    description = std::to_string(width) + "x" + std::to_string(height) + " pattern " +
+                  std::to_string(static_cast<int>(spec.pattern)) + " seed " + std::to_string(spec.seed);
+    if (roi) {
+        unsigned int x = rng.below(spec.width - width + 1);
+        unsigned int y = rng.below(spec.height - height + 1);
+        Image region;
+        img.getROI(region, x, y, width, height);
+        description += " roi at " + std::to_string(x) + "," + std::to_string(y);
+        return region;
+    }
+    return img;
+}
+
+/**
+ * @brief Prints the result table
+ * @param results Results of all checks
+ * @return true if all checks passed
+ */
+bool report(const std::vector<CheckResult>& results) {
+    bool passed = true;
+    std::cout << std::left << std::setw(28) << "check" << std::setw(8) << "cases"
+              << std::setw(10) << "max diff" << std::setw(10) << "tolerance" << "result\n";
+    for (const CheckResult& r : results) {
+        std::cout << std::left << std::setw(28) << r.name << std::setw(8) << r.cases
+                  << std::setw(10) << r.maxDifference << std::setw(10) << r.tolerance
+                  << (r.failures == 0 ? "ok" : "FAILED") << "\n";
+        if (r.failures != 0) {
+            std::cout << "    " << r.failures << " failing inputs, first: " << r.firstFailure << "\n";
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+}
+
+/**
+ * @brief Main function running all differential checks
+ * @param argc Argument count
+ * @param argv Arguments: [iterations] [seed]
+ * @return 0 if all checks passed, 1 otherwise
+ */
+int main(int argc, char** argv) {
+    unsigned int iterations = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 200;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    Random::Generator rng(seed);
+
+    CheckResult brightness{"brightness/contrast LUT", 0};
+    CheckResult gamma{"gamma LUT", 0};
+    CheckResult chain{"point operation chain", 0};
+    CheckResult batchPoint{"batched point operation", 0};
+    CheckResult convolution{"convolution (scatter form)", 1}; // Different summation order
+    CheckResult batchConvolution{"batched convolution", 0};
+    CheckResult dithering{"Floyd-Steinberg wavefront", 0};
+    CheckResult histogram{"histogram", 0};
+    CheckResult expressionAdd{"expression a + b", 0};
+    CheckResult expressionSub{"expression a - b", 0};
+    CheckResult expressionConstant{"expression a + c, a - c", 0};
+    CheckResult expressionScale{"expression a * s", 1};   // float vs double product
+    CheckResult remap{"fixed-point remap", 1};            // 8-bit fixed point blend
+    CheckResult parallelSave{"parallel save", 0};
+    CheckResult directSave{"parallel save (O_DIRECT)", 0};
+    CheckResult scaledLoad{"scaled load", 0};
+    CheckResult mosaic{"mosaic composition", 0};
+    std::string tempBase = (std::filesystem::temp_directory_path() /
+                            ("differential_check_" + std::to_string(getpid()) + "_")).string();
+
+    for (unsigned int it = 0; it < iterations; ++it) {
+        std::string input;
+        Image a = randomImage(rng, input);
+        Image expected, actual;
+
+        double alpha = rng.uniform(0.0, 3.0);
+        int beta = static_cast<int>(rng.below(201)) - 100;
+        Reference::brightnessContrast(a, expected, alpha, beta);
+        BrightnessContrastAdjustment(alpha, beta).process(a, actual);
+        record(brightness, maxDifference(expected, actual), input);
+
+        double g = rng.uniform(0.1, 4.0);
+        Reference::gamma(a, expected, g);
+        GammaCorrection(g).process(a, actual);
+        record(gamma, maxDifference(expected, actual), input);
+
+        Image step;
+        Reference::gamma(a, step, g);
+        Reference::brightnessContrast(step, expected, alpha, beta);
+        PointOperationChain pointChain;
+        pointChain.then(GammaCorrection(g)).then(BrightnessContrastAdjustment(alpha, beta));
+        pointChain.process(a, actual);
+        record(chain, maxDifference(expected, actual), input);
+
+        // Kernel sizes include even sizes and kernels larger than the image
+        int kw = 1 + static_cast<int>(rng.below(7));
+        int kh = 1 + static_cast<int>(rng.below(7));
+        std::vector<double> kernel(kw * kh);
+        double** kernelRows = new double*[kh];
+        for (int ky = 0; ky < kh; ++ky) {
+            kernelRows[ky] = new double[kw];
+            for (int kx = 0; kx < kw; ++kx) {
+                kernel[ky * kw + kx] = kernelRows[ky][kx] = rng.uniform(-1.0, 1.0);
+            }
+        }
+        double offset = rng.uniform(0.0, 128.0);
+        auto scaling = [offset](double sum) { return sum + offset; };
+        std::string kernelInput = input + " kernel " + std::to_string(kw) + "x" + std::to_string(kh);
+        Convolution conv(kernelRows, kw, kh, scaling);
+        Image gathered;
+        Reference::convolution(a, expected, kernel, kw, kh, scaling);
+        conv.process(a, gathered);
+        record(convolution, maxDifference(expected, gathered), kernelInput);
+
+        std::vector<Image> images(1 + rng.below(4), a);
+        images.back() = a + static_cast<unsigned char>(rng.below(256));
+        ImageBatch batch, batchOut;
+        batch.pack(images);
+        conv.process(batch, batchOut);
+        for (unsigned int i = 0; i < batch.count(); ++i) {
+            conv.process(images[i], expected); // The batch path promises bit-identical results
+            batchOut.unpack(i, actual);
+            record(batchConvolution, maxDifference(expected, actual), kernelInput);
+        }
+        GammaCorrection(g).process(batch, batchOut);
+        for (unsigned int i = 0; i < batch.count(); ++i) {
+            Reference::gamma(images[i], expected, g);
+            batchOut.unpack(i, actual);
+            record(batchPoint, maxDifference(expected, actual), input);
+        }
+
+        unsigned int levels = 2 + rng.below(7);
+        Reference::floydSteinberg(a, expected, levels);
+        FloydSteinbergDithering(levels).process(a, actual);
+        record(dithering, maxDifference(expected, actual), input + " levels " + std::to_string(levels));
+
+        record(histogram, Reference::histogram(a) == Histogram::compute(a) ? 0 : 256, input);
+
+        std::string otherInput;
+        Image b = randomImage(rng, otherInput);
+        if (b.width() != a.width() || b.height() != a.height()) {
+            b = a * rng.uniform(0.0, 2.0);
+        }
+        std::vector<const Image*> inputs = {&a, &b};
+        PixelExpression("a + b").evaluate(inputs, actual);
+        record(expressionAdd, maxDifference(a + b, actual), input);
+        PixelExpression("a - b").evaluate(inputs, actual);
+        record(expressionSub, maxDifference(a - b, actual), input);
+
+        unsigned int c = rng.below(256);
+        PixelExpression("a + " + std::to_string(c)).process(a, actual);
+        record(expressionConstant, maxDifference(a + static_cast<unsigned char>(c), actual), input);
+        PixelExpression("a - " + std::to_string(c)).process(a, actual);
+        record(expressionConstant, maxDifference(a - static_cast<unsigned char>(c), actual), input);
+
+        double s = std::round(rng.uniform(0.0, 4.0) * 1000) / 1000;
+        PixelExpression("a * " + std::to_string(s)).process(a, actual);
+        record(expressionScale, maxDifference(a * s, actual), input + " scale " + std::to_string(s));
+
+        // Map coordinates on the 1/256 grid, some of them outside the source
+        unsigned int mw = 1 + rng.below(80), mh = 1 + rng.below(80);
+        ImageF mapX(mw, mh), mapY(mw, mh);
+        for (unsigned int y = 0; y < mh; ++y) {
+            for (unsigned int x = 0; x < mw; ++x) {
+                mapX.at(x, y) = (static_cast<int>(rng.below((a.width() + 4) * 256)) - 512) / 256.0f;
+                mapY.at(x, y) = (static_cast<int>(rng.below((a.height() + 4) * 256)) - 512) / 256.0f;
+            }
+        }
+        unsigned char border = static_cast<unsigned char>(rng.below(256));
+        Reference::remap(a, mapX, mapY, expected, border);
+        Remap(mapX, mapY, border).process(a, actual);
+        record(remap, maxDifference(expected, actual), input);
+
+        // Positional band writes must produce exactly the bytes of the streamed save
+        std::string streamed = tempBase + "streamed.pgm";
+        std::string banded = tempBase + "banded.pgm";
+        a.save(streamed);
+        std::string reference = readFile(streamed);
+        a.saveParallel(banded, false);
+        record(parallelSave, readFile(banded) == reference ? 0 : 256, input);
+        a.saveParallel(banded, true);
+        record(directSave, readFile(banded) == reference ? 0 : 256, input);
+
+        unsigned int factor = 1 + rng.below(9);
+        bool averaged = rng.below(2) == 1;
+        Reference::downsample(a, expected, factor, averaged);
+        actual.loadScaled(streamed, factor, averaged);
+        record(scaledLoad, maxDifference(expected, actual), input + " factor " + std::to_string(factor) +
+               (averaged ? " averaged" : " subsampled"));
+
+        // Placements partly or wholly outside the canvas, including negative offsets
+        unsigned int canvasWidth = 1 + rng.below(300), canvasHeight = 1 + rng.below(600);
+        unsigned int feather = rng.below(2) == 1 ? 1 + rng.below(8) : 0;
+        unsigned char background = static_cast<unsigned char>(rng.below(256));
+        std::vector<const Image*> tiles;
+        std::vector<Point> offsets;
+        Mosaic canvas(canvasWidth, canvasHeight, feather, background);
+        for (const Image* tile : {&a, &b, &a}) {
+            int x = static_cast<int>(rng.below(canvasWidth + 2 * tile->width() + 40)) - static_cast<int>(tile->width()) - 20;
+            int y = static_cast<int>(rng.below(canvasHeight + 2 * tile->height() + 40)) - static_cast<int>(tile->height()) - 20;
+            tiles.push_back(tile);
+            offsets.push_back(Point(x, y));
+            canvas.add(*tile, offsets.back());
+        }
+        Reference::mosaic(tiles, offsets, canvasWidth, canvasHeight, feather, background, expected);
+        canvas.compose(actual);
+        record(mosaic, maxDifference(expected, actual), input + " canvas " + std::to_string(canvasWidth) + "x" +
+               std::to_string(canvasHeight) + " feather " + std::to_string(feather));
+    }
+    std::remove((tempBase + "streamed.pgm").c_str());
+    std::remove((tempBase + "banded.pgm").c_str());
+
+    std::cout << "Differential check, " << iterations << " iterations, seed " << seed << "\n";
+    bool passed = report({brightness, gamma, chain, batchPoint, convolution, batchConvolution, dithering,
+                          histogram, expressionAdd, expressionSub, expressionConstant, expressionScale, remap,
+                          parallelSave, directSave, scaledLoad, mosaic});
+    return passed ? 0 : 1;
+}
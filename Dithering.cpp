@@ -0,0 +1,230 @@
+#include "Dithering.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Constructor for ordered dithering
+ * @param levels Number of output gray levels, clamped to [2,256]
+ * @param matrixSize Size of the Bayer matrix, rounded up to a power of two in [2,16]
+ * @details Builds the Bayer matrix recursively: M(2n) = [4M, 4M+2; 4M+3, 4M+1]
+ */
+OrderedDithering::OrderedDithering(unsigned int levels, unsigned int matrixSize)
+    : levels(std::max(2u, std::min(256u, levels))), matrixSize(2) {
+    while (this->matrixSize < matrixSize && this->matrixSize < 16) {
+        this->matrixSize *= 2;
+    }
+
+    std::vector<unsigned int> bayer{0, 2, 3, 1}; // 2x2 base matrix
+    for (unsigned int n = 2; n < this->matrixSize; n *= 2) {
+        std::vector<unsigned int> next(4 * n * n);
+        for (unsigned int y = 0; y < n; ++y) {
+            for (unsigned int x = 0; x < n; ++x) {
+                unsigned int v = 4 * bayer[y * n + x];
+                next[y * 2 * n + x] = v;
+                next[y * 2 * n + x + n] = v + 2;
+                next[(y + n) * 2 * n + x] = v + 3;
+                next[(y + n) * 2 * n + x + n] = v + 1;
+            }
+        }
+        bayer.swap(next);
+    }
+
+    float cells = static_cast<float>(bayer.size());
+    thresholds.resize(bayer.size());
+    for (size_t i = 0; i < bayer.size(); ++i) {
+        thresholds[i] = (bayer[i] + 0.5f) / cells; // Centered thresholds so flat gray keeps its mean
+    }
+}
+
+/**
+ * @brief Dithers any source type into an 8-bit image
+ * @param src Source image (Image or ImageBuffer)
+ * @param dst Destination grayscale image
+ * @param maxValue Source value mapped to white
+ * @details new_level = floor(old_value * (levels-1)/maxValue + threshold(x,y)).
+ *          The threshold rows are tiled to the image width once, so the inner loop
+ *          is a branch-free multiply/add/convert the compiler can vectorize.
+ */
+template <typename Source>
+void OrderedDithering::dither(const Source& src, Image& dst, float maxValue) const {
+    unsigned int width = src.width();
+    unsigned int height = src.height();
+    dst = Image(width, height);
+    if (width == 0 || height == 0 || maxValue <= 0) {
+        return;
+    }
+
+    float scale = (levels - 1) / maxValue;   // Source value -> level units
+    float step = 255.0f / (levels - 1);      // Level -> output gray value
+    float top = static_cast<float>(levels - 1);
+
+    std::vector<float> tiled(static_cast<size_t>(matrixSize) * width); // One threshold row per matrix row
+    for (unsigned int my = 0; my < matrixSize; ++my) {
+        for (unsigned int x = 0; x < width; ++x) {
+            tiled[static_cast<size_t>(my) * width + x] = thresholds[my * matrixSize + x % matrixSize];
+        }
+    }
+
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const auto* in = src.row(y);
+            const float* t = &tiled[static_cast<size_t>(y % matrixSize) * width];
+            unsigned char* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                float v = std::max(0.0f, in[x] * scale + t[x]);
+                float q = std::min(top, static_cast<float>(static_cast<int>(v))); // Truncation is floor for v >= 0
+                out[x] = static_cast<unsigned char>(q * step + 0.5f);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Dithers an 8-bit grayscale image
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ */
+void OrderedDithering::process(const Image& src, Image& dst) {
+    dither(src, dst, 255.0f);
+}
+
+/**
+ * @brief Reduces a 16-bit image to 8 bits
+ * @param src Source 16-bit image
+ * @param dst Destination grayscale image
+ * @param maxValue Source value mapped to white
+ */
+void OrderedDithering::process(const Image16& src, Image& dst, unsigned short maxValue) {
+    dither(src, dst, static_cast<float>(maxValue));
+}
+
+/**
+ * @brief Reduces a floating point image to 8 bits
+ * @param src Source float image
+ * @param dst Destination grayscale image
+ * @param maxValue Source value mapped to white
+ */
+void OrderedDithering::process(const ImageF& src, Image& dst, float maxValue) {
+    dither(src, dst, maxValue);
+}
+
+/**
+ * @brief Constructor for Floyd-Steinberg dithering
+ * @param levels Number of output gray levels, clamped to [2,256]
+ */
+FloydSteinbergDithering::FloydSteinbergDithering(unsigned int levels)
+    : levels(std::max(2u, std::min(256u, levels))) {}
+
+/**
+ * @brief Dithers any source type into an 8-bit image
+ * @param src Source image (Image or ImageBuffer)
+ * @param dst Destination grayscale image
+ * @param maxValue Source value mapped to white
+ * @details The quantization error of each pixel is pushed to its neighbours:
+ *          7/16 right, 3/16 down-left, 5/16 down, 1/16 down-right.
+ *          Worker w handles rows w, w+n, w+2n, ... and publishes how far it got in each row.
+ *          Before a block of row y is quantized, row y-1 must be finished two pixels past
+ *          the end of the block, since pixel x of row y-1 still adds error up to x+1 of row y.
+ */
+template <typename Source>
+void FloydSteinbergDithering::dither(const Source& src, Image& dst, float maxValue) const {
+    unsigned int width = src.width();
+    unsigned int height = src.height();
+    dst = Image(width, height);
+    if (width == 0 || height == 0 || maxValue <= 0) {
+        return;
+    }
+
+    float scale = (levels - 1) / maxValue;
+    float step = 255.0f / (levels - 1);
+    float top = static_cast<float>(levels - 1);
+
+    ImageF work(width, height); // Pixel values in level units, accumulating the diffused error
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const auto* in = src.row(y);
+            float* w = work.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                w[x] = in[x] * scale;
+            }
+        }
+    });
+
+    const unsigned int block = 64; // Columns done between progress updates
+    std::vector<std::atomic<unsigned int>> progress(height);
+    for (std::atomic<unsigned int>& p : progress) {
+        p.store(0, std::memory_order_relaxed);
+    }
+
+    unsigned int workers = std::min(Parallel::threadCount(), height);
+    Parallel::run(workers, [&](unsigned int worker) {
+        for (unsigned int y = worker; y < height; y += workers) {
+            float* cur = work.row(y);
+            float* next = (y + 1 < height) ? work.row(y + 1) : nullptr;
+            unsigned char* out = dst.row(y);
+
+            for (unsigned int x0 = 0; x0 < width; x0 += block) {
+                unsigned int x1 = std::min(width, x0 + block);
+                if (y > 0) {
+                    unsigned int needed = std::min(width, x1 + 2);
+                    while (progress[y - 1].load(std::memory_order_acquire) < needed) {
+                        std::this_thread::yield(); // Row above is only a few pixels ahead, wait briefly
+                    }
+                }
+
+                for (unsigned int x = x0; x < x1; ++x) {
+                    float v = cur[x];
+                    float q = std::min(top, std::max(0.0f, static_cast<float>(static_cast<int>(v + 0.5f))));
+                    float err = v - q;
+                    out[x] = static_cast<unsigned char>(q * step + 0.5f);
+
+                    if (x + 1 < width) {
+                        cur[x + 1] += err * (7.0f / 16);
+                    }
+                    if (next != nullptr) {
+                        if (x > 0) {
+                            next[x - 1] += err * (3.0f / 16);
+                        }
+                        next[x] += err * (5.0f / 16);
+                        if (x + 1 < width) {
+                            next[x + 1] += err * (1.0f / 16);
+                        }
+                    }
+                }
+                progress[y].store(x1, std::memory_order_release);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Dithers an 8-bit grayscale image
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ */
+void FloydSteinbergDithering::process(const Image& src, Image& dst) {
+    dither(src, dst, 255.0f);
+}
+
+/**
+ * @brief Reduces a 16-bit image to 8 bits
+ * @param src Source 16-bit image
+ * @param dst Destination grayscale image
+ * @param maxValue Source value mapped to white
+ */
+void FloydSteinbergDithering::process(const Image16& src, Image& dst, unsigned short maxValue) {
+    dither(src, dst, static_cast<float>(maxValue));
+}
+
+/**
+ * @brief Reduces a floating point image to 8 bits
+ * @param src Source float image
+ * @param dst Destination grayscale image
+ * @param maxValue Source value mapped to white
+ */
+void FloydSteinbergDithering::process(const ImageF& src, Image& dst, float maxValue) {
+    dither(src, dst, maxValue);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include "ImageBuffer.h"
+#include <vector>
+
+/**
+ * @brief Class for ordered (Bayer) dithering of a grayscale image
+ * @details Quantizes the image to a given number of gray levels by adding a tiled
+ *          threshold matrix before rounding. Every pixel is independent, so rows are
+ *          processed in parallel and the inner loop is a plain vectorizable pass.
+ */
+class OrderedDithering : public ImageProcessing {
+private:
+    unsigned int levels;            ///< Number of output gray levels (2 for 1-bit output)
+    unsigned int matrixSize;        ///< Size of the Bayer matrix (2, 4, 8 or 16)
+    std::vector<float> thresholds;  ///< Normalized Bayer thresholds in [0,1), matrixSize x matrixSize
+
+    /**
+     * @brief Dithers any source type into an 8-bit image
+     * @param src Source image (Image or ImageBuffer)
+     * @param dst Destination grayscale image
+     * @param maxValue Source value mapped to white
+     */
+    template <typename Source>
+    void dither(const Source& src, Image& dst, float maxValue) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param levels Number of output gray levels (default: 2, black and white)
+     * @param matrixSize Size of the Bayer matrix, rounded up to a power of two (default: 8)
+     */
+    OrderedDithering(unsigned int levels = 2, unsigned int matrixSize = 8);
+
+    /**
+     * @brief Dithers an 8-bit grayscale image to the configured number of levels
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     */
+    void process(const Image& src, Image& dst) override;
+
+    /**
+     * @brief Reduces a 16-bit image to 8 bits with ordered dithering
+     * @param src Source 16-bit image
+     * @param dst Destination grayscale image
+     * @param maxValue Source value mapped to white (default: 65535)
+     */
+    void process(const Image16& src, Image& dst, unsigned short maxValue = 65535);
+
+    /**
+     * @brief Reduces a floating point image to 8 bits with ordered dithering
+     * @param src Source float image
+     * @param dst Destination grayscale image
+     * @param maxValue Source value mapped to white (default: 1.0)
+     */
+    void process(const ImageF& src, Image& dst, float maxValue = 1.0f);
+};
+
+/**
+ * @brief Class for Floyd-Steinberg error diffusion dithering
+ * @details Each pixel needs the finished error of its upper-left, upper and upper-right
+ *          neighbours, so rows are processed as a diagonal wavefront: every worker owns
+ *          every n-th row and only stays a couple of pixels behind the row above it.
+ *          The result is identical to the serial algorithm.
+ */
+class FloydSteinbergDithering : public ImageProcessing {
+private:
+    unsigned int levels;  ///< Number of output gray levels (2 for 1-bit output)
+
+    /**
+     * @brief Dithers any source type into an 8-bit image
+     * @param src Source image (Image or ImageBuffer)
+     * @param dst Destination grayscale image
+     * @param maxValue Source value mapped to white
+     */
+    template <typename Source>
+    void dither(const Source& src, Image& dst, float maxValue) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param levels Number of output gray levels (default: 2, black and white)
+     */
+    FloydSteinbergDithering(unsigned int levels = 2);
+
+    /**
+     * @brief Dithers an 8-bit grayscale image to the configured number of levels
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     */
+    void process(const Image& src, Image& dst) override;
+
+    /**
+     * @brief Reduces a 16-bit image to 8 bits with error diffusion
+     * @param src Source 16-bit image
+     * @param dst Destination grayscale image
+     * @param maxValue Source value mapped to white (default: 65535)
+     */
+    void process(const Image16& src, Image& dst, unsigned short maxValue = 65535);
+
+    /**
+     * @brief Reduces a floating point image to 8 bits with error diffusion
+     * @param src Source float image
+     * @param dst Destination grayscale image
+     * @param maxValue Source value mapped to white (default: 1.0)
+     */
+    void process(const ImageF& src, Image& dst, float maxValue = 1.0f);
+};
@@ -1,4 +1,5 @@
 #include "Drawing.h"
+#include <algorithm>
 #include <cmath>
 
 namespace Drawing {
@@ -23,28 +24,28 @@ void drawCircle(Image& img, Point center, int radius, unsigned char value) {
         // Draw points in all octants
         if (center.getX() + x >= 0 && center.getX() + x < img.width() && // Draw point at coords if its inside bounds
             center.getY() + y >= 0 && center.getY() + y < img.height())
-            img.at(center.getY() + y, center.getX() + x) = value;
+            img.at(center.getX() + x, center.getY() + y) = value;
         if (center.getX() + y >= 0 && center.getX() + y < img.width() && //2nd octant
             center.getY() + x >= 0 && center.getY() + x < img.height())
-            img.at(center.getY() + x, center.getX() + y) = value;
+            img.at(center.getX() + y, center.getY() + x) = value;
         if (center.getX() - x >= 0 && center.getX() - x < img.width() && // 3rd octant
             center.getY() + y >= 0 && center.getY() + y < img.height())
-            img.at(center.getY() + y, center.getX() - x) = value;
+            img.at(center.getX() - x, center.getY() + y) = value;
         if (center.getX() - y >= 0 && center.getX() - y < img.width() && // 4th octant
             center.getY() + x >= 0 && center.getY() + x < img.height())
-            img.at(center.getY() + x, center.getX() - y) = value;
+            img.at(center.getX() - y, center.getY() + x) = value;
         if (center.getX() + x >= 0 && center.getX() + x < img.width() && //5th octant
             center.getY() - y >= 0 && center.getY() - y < img.height())
-            img.at(center.getY() - y, center.getX() + x) = value;
+            img.at(center.getX() + x, center.getY() - y) = value;
         if (center.getX() + y >= 0 && center.getX() + y < img.width() && // 6th octant
             center.getY() - x >= 0 && center.getY() - x < img.height())
-            img.at(center.getY() - x, center.getX() + y) = value;
+            img.at(center.getX() + y, center.getY() - x) = value;
         if (center.getX() - x >= 0 && center.getX() - x < img.width() && // 7th octant
             center.getY() - y >= 0 && center.getY() - y < img.height())
-            img.at(center.getY() - y, center.getX() - x) = value;
+            img.at(center.getX() - x, center.getY() - y) = value;
         if (center.getX() - y >= 0 && center.getX() - y < img.width() && // 8th octant
             center.getY() - x >= 0 && center.getY() - x < img.height())
-            img.at(center.getY() - x, center.getX() - y) = value;
+            img.at(center.getX() - y, center.getY() - x) = value;
         
         if (d < 0) { // Point is inside the circle
             d += 4 * x + 6; // Move horizontally
@@ -131,4 +132,65 @@ void drawRectangle(Image& img, Point tl, Point br, unsigned char value) {
     drawLine(img, bl, tl, value);
 }
 
-}
\ No newline at end of file
+/**
+ * @brief Fills a rectangle on the grayscale image
+ * @param img Grayscale image to draw on
+ * @param r Rectangle to fill
+ * @param value Grayscale value to use for filling (0-255)
+ * @details Covers columns getX() .. getX() + getWidth() - 1 and the matching rows,
+ *          clipped to the image. Each row is filled with one contiguous store.
+ */
+void fillRectangle(Image& img, Rectangle r, unsigned char value) {
+    int x0 = std::max(r.getX(), 0);
+    int y0 = std::max(r.getY(), 0);
+    int x1 = std::min(r.getBottomRight().getX(), static_cast<int>(img.width()));
+    int y1 = std::min(r.getBottomRight().getY(), static_cast<int>(img.height()));
+
+    for (int y = y0; y < y1; ++y) {
+        if (x1 > x0) {
+            std::fill(img.row(y) + x0, img.row(y) + x1, value);
+        }
+    }
+}
+
+/**
+ * @brief Draws a polyline on the grayscale image
+ * @param img Grayscale image to draw on
+ * @param pts Points of the polyline
+ * @param count Number of points
+ * @param closed true to connect the last point back to the first
+ * @param value Grayscale value to use for drawing (0-255)
+ * @details Connects consecutive points with Bresenham lines.
+ *          A single point is drawn as a pixel.
+ */
+void drawPolyline(Image& img, const Point* pts, size_t count, bool closed, unsigned char value) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1) {
+        drawLine(img, pts[0], pts[0], value);
+        return;
+    }
+
+    for (size_t i = 1; i < count; ++i) {
+        drawLine(img, pts[i - 1], pts[i], value);
+    }
+    if (closed) {
+        drawLine(img, pts[count - 1], pts[0], value);
+    }
+}
+
+/**
+ * @brief Draws all contours of a contour set on the grayscale image
+ * @param img Grayscale image to draw on
+ * @param contours Contours to draw
+ * @param value Grayscale value to use for drawing (0-255)
+ * @details Walks the flat point array once, drawing every contour as a closed polyline
+ */
+void drawContours(Image& img, const ContourSet& contours, unsigned char value) {
+    for (size_t k = 0; k < contours.size(); ++k) {
+        drawPolyline(img, contours.contour(k), contours.length(k), true, value);
+    }
+}
+
+}
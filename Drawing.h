@@ -3,6 +3,8 @@
 #include "Image.h"
 #include "Point.h"
 #include "Rectangle.h"
+#include "Contours.h"
+#include <cstddef>
 
 /**
  * @brief Namespace containing drawing functions for grayscale images
@@ -43,4 +45,30 @@ namespace Drawing {
      * @param value Grayscale value to use for drawing (0-255)
      */
     void drawRectangle(Image& img, Point tl, Point br, unsigned char value);
-} 
\ No newline at end of file
+
+    /**
+     * @brief Fills a rectangle on the grayscale image
+     * @param img Grayscale image to draw on
+     * @param r Rectangle to fill, clipped to the image
+     * @param value Grayscale value to use for filling (0-255)
+     */
+    void fillRectangle(Image& img, Rectangle r, unsigned char value);
+
+    /**
+     * @brief Draws a polyline on the grayscale image
+     * @param img Grayscale image to draw on
+     * @param pts Points of the polyline
+     * @param count Number of points
+     * @param closed true to connect the last point back to the first
+     * @param value Grayscale value to use for drawing (0-255)
+     */
+    void drawPolyline(Image& img, const Point* pts, size_t count, bool closed, unsigned char value);
+
+    /**
+     * @brief Draws all contours of a contour set on the grayscale image
+     * @param img Grayscale image to draw on
+     * @param contours Contours to draw
+     * @param value Grayscale value to use for drawing (0-255)
+     */
+    void drawContours(Image& img, const ContourSet& contours, unsigned char value);
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "Features.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+const float pi = 3.14159265358979f;
+
+/**
+ * @brief Builds the table mapping LBP codes to uniform pattern bins
+ * @return Table with bins 0..57 for uniform codes and 58 for all others
+ */
+std::array<unsigned char, 256> makeUniformTable() {
+    std::array<unsigned char, 256> table;
+    unsigned char next = 0;
+    for (int code = 0; code < 256; ++code) {
+        int transitions = 0;
+        for (int k = 0; k < 8; ++k) {
+            transitions += ((code >> k) & 1) != ((code >> ((k + 1) % 8)) & 1);
+        }
+        table[code] = transitions <= 2 ? next++ : 58;
+    }
+    return table;
+}
+
+const std::array<unsigned char, 256> uniformBin = makeUniformTable();
+
+/**
+ * @brief Computes the LBP code of a pixel, clamping neighbours to the image
+ * @param img Source image
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @return Code with bit k set if neighbour k (clockwise from top-left) >= center
+ */
+inline unsigned char lbpCode(const Image& img, unsigned int x, unsigned int y) {
+    unsigned int xl = x > 0 ? x - 1 : x, xr = x + 1 < img.width() ? x + 1 : x;
+    const unsigned char* up = img.row(y > 0 ? y - 1 : y);
+    const unsigned char* mid = img.row(y);
+    const unsigned char* down = img.row(y + 1 < img.height() ? y + 1 : y);
+    unsigned char c = mid[x];
+    return static_cast<unsigned char>(
+        (up[xl] >= c) | (up[x] >= c) << 1 | (up[xr] >= c) << 2 | (mid[xr] >= c) << 3 |
+        (down[xr] >= c) << 4 | (down[x] >= c) << 5 | (down[xl] >= c) << 6 | (mid[xl] >= c) << 7);
+}
+
+/**
+ * @brief Checks that every region lies inside the image
+ * @param img Image
+ * @param rois Regions
+ * @return true if all regions are valid
+ */
+bool roisInside(const Image& img, const std::vector<Rectangle>& rois) {
+    for (const Rectangle& r : rois) {
+        if (r.getX() < 0 || r.getY() < 0 ||
+            r.getX() + r.getWidth() > img.width() || r.getY() + r.getHeight() > img.height()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+namespace Features {
+
+/**
+ * @brief Computes the 8-neighbour LBP code of every pixel
+ * @param src Source grayscale image
+ * @param dst Destination image of LBP codes
+ */
+void lbpImage(const Image& src, Image& dst) {
+    dst = Image(src.width(), src.height());
+    Parallel::forRange(src.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            unsigned char* out = dst.row(y);
+            for (unsigned int x = 0; x < src.width(); ++x) {
+                out[x] = lbpCode(src, x, y);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Computes normalized uniform LBP histograms for a batch of ROIs
+ * @param img Source grayscale image
+ * @param rois Regions
+ * @param out Buffer of rois.size() * lbpBins floats
+ * @return true if successful
+ * @details Each histogram is normalized to sum 1. ROIs are processed in parallel
+ */
+bool lbpHistograms(const Image& img, const std::vector<Rectangle>& rois, float* out) {
+    if (!roisInside(img, rois)) {
+        return false;
+    }
+
+    Parallel::forRange(static_cast<unsigned int>(rois.size()), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i) {
+            const Rectangle& r = rois[i];
+            unsigned int counts[lbpBins] = {};
+            for (unsigned int y = r.getY(); y < r.getY() + r.getHeight(); ++y) {
+                for (unsigned int x = r.getX(); x < r.getX() + r.getWidth(); ++x) {
+                    ++counts[uniformBin[lbpCode(img, x, y)]];
+                }
+            }
+
+            float* h = out + i * lbpBins;
+            float total = static_cast<float>(r.getWidth()) * r.getHeight();
+            for (size_t b = 0; b < lbpBins; ++b) {
+                h[b] = total > 0 ? counts[b] / total : 0.0f;
+            }
+        }
+    }, 1);
+    return true;
+}
+
+/**
+ * @brief Gets the length of a HOG descriptor
+ * @param width Width of the region
+ * @param height Height of the region
+ * @param params HOG parameters
+ * @return Number of floats per region
+ */
+size_t hogSize(unsigned int width, unsigned int height, const HOGParameters& params) {
+    if (params.cellSize == 0 || params.blockCells == 0) {
+        return 0;
+    }
+    unsigned int cellsX = width / params.cellSize;
+    unsigned int cellsY = height / params.cellSize;
+    if (cellsX < params.blockCells || cellsY < params.blockCells) {
+        return 0;
+    }
+    size_t blocks = static_cast<size_t>(cellsX - params.blockCells + 1) * (cellsY - params.blockCells + 1);
+    return blocks * params.blockCells * params.blockCells * params.bins;
+}
+
+/**
+ * @brief Computes HOG descriptors for a batch of equally sized ROIs
+ * @param img Source grayscale image
+ * @param rois Regions
+ * @param out Buffer of rois.size() * hogSize(...) floats
+ * @param params HOG parameters
+ * @return true if successful
+ * @details For every pixel one fused step computes the central difference gradient,
+ *          its magnitude and unsigned orientation and votes into the cell histogram,
+ *          split linearly between the two nearest orientation bins. Overlapping blocks
+ *          of cells are then L2-Hys normalized (normalize, clip, normalize again).
+ *          Each thread reuses one cell-histogram buffer for all its ROIs
+ */
+bool hog(const Image& img, const std::vector<Rectangle>& rois, float* out, const HOGParameters& params) {
+    if (rois.empty()) {
+        return true;
+    }
+    unsigned int width = rois[0].getWidth();
+    unsigned int height = rois[0].getHeight();
+    size_t length = hogSize(width, height, params);
+    if (length == 0 || params.bins == 0 || !roisInside(img, rois)) {
+        return false;
+    }
+    for (const Rectangle& r : rois) {
+        if (r.getWidth() != width || r.getHeight() != height) {
+            return false;
+        }
+    }
+
+    unsigned int cellsX = width / params.cellSize;
+    unsigned int cellsY = height / params.cellSize;
+    unsigned int bins = params.bins;
+    unsigned int bc = params.blockCells;
+    float binWidth = pi / bins;
+
+    Parallel::forRange(static_cast<unsigned int>(rois.size()), [&](unsigned int begin, unsigned int end) {
+        std::vector<float> cells(static_cast<size_t>(cellsX) * cellsY * bins);
+
+        for (unsigned int i = begin; i < end; ++i) {
+            const Rectangle& r = rois[i];
+            std::fill(cells.begin(), cells.end(), 0.0f);
+
+            for (unsigned int cy = 0; cy < cellsY * params.cellSize; ++cy) {
+                unsigned int y = r.getY() + cy;
+                const unsigned char* up = img.row(y > 0 ? y - 1 : y);
+                const unsigned char* mid = img.row(y);
+                const unsigned char* down = img.row(y + 1 < img.height() ? y + 1 : y);
+                float* cellRow = &cells[static_cast<size_t>(cy / params.cellSize) * cellsX * bins];
+
+                for (unsigned int cx = 0; cx < cellsX * params.cellSize; ++cx) {
+                    unsigned int x = r.getX() + cx;
+                    unsigned int xl = x > 0 ? x - 1 : x, xr = x + 1 < img.width() ? x + 1 : x;
+                    float gx = static_cast<float>(mid[xr]) - mid[xl];
+                    float gy = static_cast<float>(down[x]) - up[x];
+                    float magnitude = std::sqrt(gx * gx + gy * gy);
+                    float angle = std::atan2(gy, gx);
+                    if (angle < 0) {
+                        angle += pi; // Unsigned orientation
+                    }
+
+                    float pos = angle / binWidth - 0.5f; // Bin centers at (k + 0.5) * binWidth
+                    int b0 = static_cast<int>(std::floor(pos));
+                    float w1 = pos - b0;
+                    int b1 = b0 + 1;
+                    b0 = (b0 + bins) % bins;
+                    b1 = b1 % bins;
+
+                    float* h = cellRow + static_cast<size_t>(cx / params.cellSize) * bins;
+                    h[b0] += magnitude * (1.0f - w1);
+                    h[b1] += magnitude * w1;
+                }
+            }
+
+            float* desc = out + i * length;
+            for (unsigned int by = 0; by + bc <= cellsY; ++by) {
+                for (unsigned int bx = 0; bx + bc <= cellsX; ++bx) {
+                    float* block = desc;
+                    for (unsigned int yy = 0; yy < bc; ++yy) {
+                        const float* src = &cells[(static_cast<size_t>(by + yy) * cellsX + bx) * bins];
+                        desc = std::copy(src, src + static_cast<size_t>(bc) * bins, desc);
+                    }
+
+                    size_t n = static_cast<size_t>(bc) * bc * bins;
+                    for (int pass = 0; pass < 2; ++pass) {
+                        float sum = 1e-6f;
+                        for (size_t k = 0; k < n; ++k) {
+                            sum += block[k] * block[k];
+                        }
+                        float scale = 1.0f / std::sqrt(sum);
+                        for (size_t k = 0; k < n; ++k) {
+                            block[k] = pass == 0 ? std::min(params.clip, block[k] * scale) : block[k] * scale;
+                        }
+                    }
+                }
+            }
+        }
+    }, 1);
+    return true;
+}
+
+}
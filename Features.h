@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Image.h"
+#include "Rectangle.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Structure holding HOG parameters
+ */
+struct HOGParameters {
+    unsigned int cellSize = 8;    ///< Cell width and height in pixels
+    unsigned int blockCells = 2;  ///< Block width and height in cells (blocks overlap by one cell stride)
+    unsigned int bins = 9;        ///< Orientation bins over 0..180 degrees
+    float clip = 0.2f;            ///< L2-Hys clipping threshold
+};
+
+/**
+ * @brief Namespace containing classical feature descriptors for ML preprocessing
+ * @details Batch functions write the features of all ROIs into one caller-provided
+ *          contiguous buffer, ROI after ROI, and allocate scratch memory once per thread
+ *          instead of once per ROI
+ */
+namespace Features {
+    /**
+     * @brief Number of bins of a uniform LBP histogram
+     * @details 58 uniform patterns (at most two 0/1 transitions) plus one bin for the rest
+     */
+    const size_t lbpBins = 59;
+
+    /**
+     * @brief Computes the 8-neighbour LBP code of every pixel
+     * @param src Source grayscale image
+     * @param dst Destination image of LBP codes (0-255)
+     */
+    void lbpImage(const Image& src, Image& dst);
+
+    /**
+     * @brief Computes normalized uniform LBP histograms for a batch of ROIs
+     * @param img Source grayscale image
+     * @param rois Regions, all inside the image
+     * @param out Buffer of rois.size() * lbpBins floats
+     * @return true if successful, false if a region is outside the image
+     */
+    bool lbpHistograms(const Image& img, const std::vector<Rectangle>& rois, float* out);
+
+    /**
+     * @brief Gets the length of a HOG descriptor
+     * @param width Width of the region
+     * @param height Height of the region
+     * @param params HOG parameters
+     * @return Number of floats per region, 0 if the region is smaller than one block
+     */
+    size_t hogSize(unsigned int width, unsigned int height, const HOGParameters& params = HOGParameters());
+
+    /**
+     * @brief Computes HOG descriptors for a batch of equally sized ROIs
+     * @param img Source grayscale image
+     * @param rois Regions, all inside the image and of the same size
+     * @param out Buffer of rois.size() * hogSize(width, height, params) floats
+     * @param params HOG parameters
+     * @return true if successful, false if regions are outside the image or differ in size
+     */
+    bool hog(const Image& img, const std::vector<Rectangle>& rois, float* out, const HOGParameters& params = HOGParameters());
+}
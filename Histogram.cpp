@@ -0,0 +1,118 @@
+#include "Histogram.h"
+#include "Parallel.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace Histogram {
+
+/**
+ * @brief Computes the histogram of an image in one pass
+ * @param img Grayscale image
+ * @return Number of pixels for each gray value
+ * @details Each row band counts into four interleaved sub-histograms, so runs of equal
+ *          pixels do not stall on the same counter, then the partial results are merged
+ */
+Counts compute(const Image& img) {
+    Counts total{};
+    std::mutex totalMutex;
+
+    unsigned int width = img.width();
+    Parallel::forRange(img.height(), [&](unsigned int begin, unsigned int end) {
+        unsigned int partial[4][256] = {}; // 32-bit counters are enough per band row
+        Counts local{};
+
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned char* in = img.row(y);
+            unsigned int x = 0;
+            for (; x + 4 <= width; x += 4) {
+                ++partial[0][in[x]];
+                ++partial[1][in[x + 1]];
+                ++partial[2][in[x + 2]];
+                ++partial[3][in[x + 3]];
+            }
+            for (; x < width; ++x) {
+                ++partial[0][in[x]];
+            }
+
+            for (int v = 0; v < 256; ++v) { // Flush every row so the 32-bit counters cannot overflow
+                local[v] += static_cast<unsigned long long>(partial[0][v]) + partial[1][v] + partial[2][v] + partial[3][v];
+                partial[0][v] = partial[1][v] = partial[2][v] = partial[3][v] = 0;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(totalMutex);
+        for (int v = 0; v < 256; ++v) {
+            total[v] += local[v];
+        }
+    });
+    return total;
+}
+
+/**
+ * @brief Computes the normalized cumulative distribution of a histogram
+ * @param counts Histogram
+ * @return Cumulative distribution in [0,1]
+ */
+Distribution cumulative(const Counts& counts) {
+    Distribution cdf{};
+    unsigned long long sum = 0;
+    for (int v = 0; v < 256; ++v) {
+        sum += counts[v];
+    }
+    if (sum == 0) {
+        return cdf;
+    }
+
+    unsigned long long running = 0;
+    for (int v = 0; v < 256; ++v) {
+        running += counts[v];
+        cdf[v] = static_cast<double>(running) / sum;
+    }
+    return cdf;
+}
+
+}
+
+/**
+ * @brief Constructor with a reference histogram
+ * @param reference Histogram the result should follow
+ */
+HistogramMatching::HistogramMatching(const Histogram::Counts& reference)
+    : referenceCdf(Histogram::cumulative(reference)) {}
+
+/**
+ * @brief Constructor with a reference image
+ * @param reference Image whose histogram the result should follow
+ */
+HistogramMatching::HistogramMatching(const Image& reference)
+    : HistogramMatching(Histogram::compute(reference)) {}
+
+/**
+ * @brief Builds the mapping for a source image
+ * @param src Source grayscale image
+ * @return Lookup table matching the histogram of src to the reference
+ * @details For each source value v picks the smallest reference value r with
+ *          cdfRef(r) >= cdfSrc(v). Both CDFs are monotonic, so one sweep is enough
+ */
+std::array<unsigned char, 256> HistogramMatching::lookupTable(const Image& src) const {
+    Histogram::Distribution sourceCdf = Histogram::cumulative(Histogram::compute(src));
+
+    std::array<unsigned char, 256> mapping;
+    int r = 0;
+    for (int v = 0; v < 256; ++v) {
+        while (r < 255 && referenceCdf[r] < sourceCdf[v]) {
+            ++r;
+        }
+        mapping[v] = static_cast<unsigned char>(r);
+    }
+    return mapping;
+}
+
+/**
+ * @brief Maps a single gray value without a source image
+ * @return Never returns
+ * @throws std::logic_error always, instead of silently acting as the identity
+ */
+unsigned char HistogramMatching::apply(unsigned char) const {
+    throw std::logic_error("HistogramMatching: the mapping needs a source image, use lookupTable(src)");
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Image.h"
+#include "ImageProcessing.h"
+#include <array>
+
+/**
+ * @brief Namespace containing gray level histogram utilities
+ */
+namespace Histogram {
+    using Counts = std::array<unsigned long long, 256>;  ///< Number of pixels per gray value
+    using Distribution = std::array<double, 256>;         ///< Normalized cumulative distribution
+
+    /**
+     * @brief Computes the histogram of an image in one pass
+     * @param img Grayscale image
+     * @return Number of pixels for each gray value
+     */
+    Counts compute(const Image& img);
+
+    /**
+     * @brief Computes the normalized cumulative distribution of a histogram
+     * @param counts Histogram
+     * @return cdf[v] = fraction of pixels with value <= v (all zeros for an empty histogram)
+     */
+    Distribution cumulative(const Counts& counts);
+}
+
+/**
+ * @brief Class for histogram matching (specification)
+ * @details Remaps the image so its histogram follows a reference histogram.
+ *          The mapping is computed from the source and reference CDFs and applied
+ *          as a single lookup table, like any other point operation.
+ */
+class HistogramMatching : public PointOperation {
+private:
+    Histogram::Distribution referenceCdf;  ///< Cumulative distribution to match
+
+public:
+    /**
+     * @brief Constructor with a reference histogram
+     * @param reference Histogram the result should follow
+     */
+    HistogramMatching(const Histogram::Counts& reference);
+
+    /**
+     * @brief Constructor with a reference image
+     * @param reference Image whose histogram the result should follow
+     */
+    HistogramMatching(const Image& reference);
+
+    /**
+     * @brief Checks if the mapping depends on the image it is applied to
+     * @return Always true, the mapping is built from the source histogram
+     */
+    bool isContentDependent() const override { return true; }
+
+    /**
+     * @brief Builds the mapping for a source image
+     * @param src Source grayscale image
+     * @return Lookup table matching the histogram of src to the reference
+     */
+    std::array<unsigned char, 256> lookupTable(const Image& src) const override;
+
+    /**
+     * @brief Maps a single gray value without a source image
+     * @param value Source gray value
+     * @return Never returns
+     * @throws std::logic_error always; the mapping needs a source image, see lookupTable(src)
+     */
+    unsigned char apply(unsigned char value) const override;
+};
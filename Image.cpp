@@ -3,6 +3,161 @@
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "Parallel.h"
+
+namespace {
+const size_t directAlignment = 4096;      ///< Offset, size and buffer alignment for O_DIRECT
+const size_t directChunk = 4 << 20;       ///< Bytes per O_DIRECT write
+const size_t bandBytes = 1 << 20;         ///< Approximate bytes per band in buffered mode
+
+/**
+ * @brief Builds the P5 header
+ * @param width Width of the image
+ * @param height Height of the image
+ * @return Header text; its length fixes the offset of every row
+ */
+std::string pgmHeader(unsigned int width, unsigned int height) {
+    return "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+}
+
+/**
+ * @brief Parses a P2 or P5 header from the start of a file
+ * @param fd File descriptor
+ * @param info Receives the header fields
+ * @return true if the header is complete
+ * @details Reads at most the first 4 KiB with a positional read; "#" comments are skipped
+ */
+bool readHeader(int fd, PGMInfo& info) {
+    char text[4096];
+    ssize_t size = pread(fd, text, sizeof(text), 0);
+    if (size < 3 || text[0] != 'P' || (text[1] != '5' && text[1] != '2')) {
+        return false;
+    }
+
+    ssize_t pos = 2;
+    unsigned long long fields[3];
+    for (unsigned long long& field : fields) {
+        while (pos < size && (std::isspace(static_cast<unsigned char>(text[pos])) || text[pos] == '#')) {
+            if (text[pos] == '#') {
+                while (pos < size && text[pos] != '\n') {
+                    ++pos;
+                }
+            } else {
+                ++pos;
+            }
+        }
+        if (pos >= size || !std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            return false;
+        }
+        field = 0;
+        while (pos < size && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            field = field * 10 + static_cast<unsigned int>(text[pos++] - '0');
+            if (field > 0xFFFFFFFFull) {
+                return false;
+            }
+        }
+    }
+    if (pos >= size || !std::isspace(static_cast<unsigned char>(text[pos]))) {
+        return false; // Exactly one whitespace character separates header and data
+    }
+
+    info.format = std::string(text, 2);
+    info.width = static_cast<unsigned int>(fields[0]);
+    info.height = static_cast<unsigned int>(fields[1]);
+    info.maxValue = static_cast<unsigned int>(fields[2]);
+    info.dataOffset = static_cast<size_t>(pos + 1);
+    return true;
+}
+
+/**
+ * @brief Reads a buffer completely from an offset
+ * @param fd File descriptor
+ * @param data Buffer
+ * @param size Number of bytes
+ * @param offset File offset
+ * @return true if all bytes were read
+ */
+bool readAt(int fd, unsigned char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a buffer completely at an offset
+ * @param fd File descriptor
+ * @param data Bytes to write
+ * @param size Number of bytes
+ * @param offset File offset
+ * @return true if all bytes were written
+ */
+bool writeAt(int fd, const unsigned char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+/**
+ * @brief Fills a buffer with the file bytes [begin, end)
+ * @param header P5 header
+ * @param width Width of the image
+ * @param producer Row producer
+ * @param begin First file offset
+ * @param end File offset past the last byte
+ * @param out Output buffer of end - begin bytes
+ * @param rows Scratch buffer for the rows touching the range
+ * @details Rows cut by the range limits are produced completely and only partly copied
+ */
+void fillRange(const std::string& header, unsigned int width,
+               const std::function<void(unsigned int, unsigned int, unsigned char*)>& producer,
+               size_t begin, size_t end, unsigned char* out, std::vector<unsigned char>& rows) {
+    size_t h = header.size();
+    for (size_t i = begin; i < std::min(end, h); ++i) {
+        out[i - begin] = static_cast<unsigned char>(header[i]);
+    }
+    if (end <= h || width == 0) {
+        return;
+    }
+
+    size_t first = std::max(begin, h) - h;  // Pixel offsets
+    size_t last = end - h;
+    unsigned int y0 = static_cast<unsigned int>(first / width);
+    unsigned int y1 = static_cast<unsigned int>((last - 1) / width + 1);
+    rows.resize(static_cast<size_t>(y1 - y0) * width);
+    producer(y0, y1, rows.data());
+    std::copy(rows.begin() + (first - static_cast<size_t>(y0) * width),
+              rows.begin() + (last - static_cast<size_t>(y0) * width),
+              out + (std::max(begin, h) - begin));
+}
+}
 
 /**
  * @brief Default constructor for Image class
@@ -124,6 +279,107 @@ bool Image::load(std::string imagePath) {
     return true;
 }
 
+/**
+ * @brief Reads only the header of a PGM file
+ * @param imagePath Path to the PGM file
+ * @param info Receives format, dimensions, maximum value and data offset
+ * @return true if the file starts with a complete P2 or P5 header, false otherwise
+ */
+bool Image::probe(const std::string& imagePath, PGMInfo& info) {
+    int fd = open(imagePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = readHeader(fd, info);
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Loads a P5 PGM image reduced by an integer factor
+ * @param imagePath Path to the P5 PGM image file
+ * @param factor Reduction factor
+ * @param average true to average blocks, false to subsample
+ * @return true if loading was successful, false otherwise
+ * @details Output rows are produced in parallel, each with positional reads:
+ *          subsampling reads one source row per output row, averaging reads the
+ *          factor consecutive source rows of the block in one call and sums them per
+ *          column. Blocks cut by the right or bottom edge average the pixels they cover.
+ *          Only 8-bit files are supported; truncated files are rejected
+ */
+bool Image::loadScaled(const std::string& imagePath, unsigned int factor, bool average) {
+    if (factor == 0) {
+        return false;
+    }
+    int fd = open(imagePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    PGMInfo info;
+    struct stat st;
+    if (!readHeader(fd, info) || info.format != "P5" || info.maxValue == 0 || info.maxValue > 255 || fstat(fd, &st) != 0 ||
+        static_cast<unsigned long long>(st.st_size) < info.dataOffset + static_cast<unsigned long long>(info.width) * info.height) {
+        close(fd);
+        return false;
+    }
+
+    unsigned int srcWidth = info.width;
+    unsigned int srcHeight = info.height;
+    unsigned int outWidth = (srcWidth + factor - 1) / factor;
+    unsigned int outHeight = (srcHeight + factor - 1) / factor;
+    Image result(outWidth, outHeight);
+
+    std::atomic<bool> ok(true);
+    Parallel::forRange(outHeight, [&](unsigned int begin, unsigned int end) {
+        std::vector<unsigned char> rows;
+        std::vector<unsigned long long> sums(outWidth);
+        for (unsigned int oy = begin; oy < end && ok; ++oy) {
+            unsigned int y0 = oy * factor;
+            unsigned int blockRows = average ? std::min(factor, srcHeight - y0) : 1;
+            rows.resize(static_cast<size_t>(blockRows) * srcWidth);
+            off_t offset = static_cast<off_t>(info.dataOffset + static_cast<size_t>(y0) * srcWidth);
+            if (!readAt(fd, rows.data(), rows.size(), offset)) {
+                ok = false;
+                break;
+            }
+
+            unsigned char* out = result.m_data[oy];
+            if (!average) {
+                for (unsigned int ox = 0; ox < outWidth; ++ox) {
+                    out[ox] = rows[static_cast<size_t>(ox) * factor];
+                }
+                continue;
+            }
+
+            std::fill(sums.begin(), sums.end(), 0);
+            for (unsigned int r = 0; r < blockRows; ++r) {
+                const unsigned char* row = &rows[static_cast<size_t>(r) * srcWidth];
+                for (unsigned int ox = 0; ox < outWidth; ++ox) {
+                    unsigned int x0 = ox * factor;
+                    unsigned int x1 = std::min(srcWidth, x0 + factor);
+                    unsigned long long sum = 0;
+                    for (unsigned int x = x0; x < x1; ++x) {
+                        sum += row[x];
+                    }
+                    sums[ox] += sum;
+                }
+            }
+            for (unsigned int ox = 0; ox < outWidth; ++ox) {
+                unsigned long long count = static_cast<unsigned long long>(blockRows) * std::min(factor, srcWidth - ox * factor);
+                out[ox] = static_cast<unsigned char>((sums[ox] + count / 2) / count);
+            }
+        }
+    }, 1);
+
+    close(fd);
+    if (!ok) {
+        return false;
+    }
+    *this = result;
+    return true;
+}
+
 /**
  * @brief Saves the image to a PGM file
  * @param imagePath Path where to save the image
@@ -148,6 +404,113 @@ bool Image::save(std::string imagePath) {
     return true;
 }
 
+/**
+ * @brief Saves the image to a P5 PGM file with parallel positional writes
+ * @param imagePath Path where to save the image
+ * @param direct true to use O_DIRECT
+ * @return true if saving was successful, false otherwise
+ */
+bool Image::saveParallel(const std::string& imagePath, bool direct) const {
+    return saveBands(imagePath, m_width, m_height, [this](unsigned int y0, unsigned int y1, unsigned char* rows) {
+        for (unsigned int y = y0; y < y1; ++y) {
+            std::copy(m_data[y], m_data[y] + m_width, rows + static_cast<size_t>(y - y0) * m_width);
+        }
+    }, direct);
+}
+
+/**
+ * @brief Writes a P5 PGM file whose rows are produced band by band in parallel
+ * @param imagePath Path where to save the image
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param producer Row producer
+ * @param direct true to use O_DIRECT
+ * @return true if saving was successful, false otherwise
+ * @details The header length is known up front, so every row has a fixed file offset.
+ *          The file is preallocated and each worker pwrite()s its own bands.
+ *          In direct mode the file is split into 4 MiB chunks on 4 KiB boundaries
+ *          instead of row bands, each assembled in an aligned buffer and written with
+ *          O_DIRECT; the unaligned tail goes through a normal descriptor. If the file
+ *          system rejects O_DIRECT, buffered writes are used
+ */
+bool Image::saveBands(const std::string& imagePath, unsigned int width, unsigned int height,
+                      const std::function<void(unsigned int, unsigned int, unsigned char*)>& producer,
+                      bool direct) {
+    std::string header = pgmHeader(width, height);
+    size_t total = header.size() + static_cast<size_t>(width) * height;
+
+    int fd = open(imagePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (posix_fallocate(fd, 0, static_cast<off_t>(total)) != 0 && ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    std::atomic<bool> ok(true);
+    int directFd = -1;
+#ifdef O_DIRECT
+    if (direct) {
+        directFd = open(imagePath.c_str(), O_WRONLY | O_DIRECT);
+    }
+#endif
+
+    if (directFd >= 0) {
+        size_t alignedEnd = total / directAlignment * directAlignment;
+        unsigned int chunks = static_cast<unsigned int>((alignedEnd + directChunk - 1) / directChunk);
+
+        Parallel::forRange(chunks, [&](unsigned int begin, unsigned int end) {
+            void* memory = nullptr;
+            if (posix_memalign(&memory, directAlignment, directChunk) != 0) {
+                ok = false;
+                return;
+            }
+            unsigned char* buffer = static_cast<unsigned char*>(memory);
+            std::vector<unsigned char> rows;
+            for (unsigned int k = begin; k < end && ok; ++k) {
+                size_t from = k * directChunk;
+                size_t to = std::min(alignedEnd, from + directChunk);
+                fillRange(header, width, producer, from, to, buffer, rows);
+                if (!writeAt(directFd, buffer, to - from, static_cast<off_t>(from))) {
+                    ok = false;
+                }
+            }
+            std::free(memory);
+        }, 1);
+
+        if (alignedEnd < total) {
+            std::vector<unsigned char> tail(total - alignedEnd), rows;
+            fillRange(header, width, producer, alignedEnd, total, tail.data(), rows);
+            ok = ok && writeAt(fd, tail.data(), tail.size(), static_cast<off_t>(alignedEnd));
+        }
+        close(directFd);
+    } else {
+        ok = writeAt(fd, reinterpret_cast<const unsigned char*>(header.data()), header.size(), 0);
+        unsigned int bandHeight = static_cast<unsigned int>(std::max<size_t>(1, bandBytes / std::max(1u, width)));
+        unsigned int bands = (height + bandHeight - 1) / bandHeight;
+
+        Parallel::forRange(bands, [&](unsigned int begin, unsigned int end) {
+            std::vector<unsigned char> rows;
+            for (unsigned int b = begin; b < end && ok; ++b) {
+                unsigned int y0 = b * bandHeight;
+                unsigned int y1 = std::min(height, y0 + bandHeight);
+                rows.resize(static_cast<size_t>(y1 - y0) * width);
+                producer(y0, y1, rows.data());
+                off_t offset = static_cast<off_t>(header.size() + static_cast<size_t>(y0) * width);
+                if (!writeAt(fd, rows.data(), rows.size(), offset)) {
+                    ok = false;
+                }
+            }
+        }, 1);
+    }
+
+    if (close(fd) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
 /**
  * @brief Assignment operator
  * @param other Source image to copy from
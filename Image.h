@@ -5,6 +5,18 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <functional>
+
+/**
+ * @brief Structure holding the header fields of a PGM file
+ */
+struct PGMInfo {
+    std::string format;         ///< Magic number, "P5" (binary) or "P2" (ASCII)
+    unsigned int width = 0;     ///< Image width
+    unsigned int height = 0;    ///< Image height
+    unsigned int maxValue = 0;  ///< Largest gray value
+    size_t dataOffset = 0;      ///< File offset of the raster
+};
 
 /**
  * @brief Class representing a 2D grayscale image
@@ -69,6 +81,26 @@ public:
      */
     bool load(std::string imagePath);
 
+    /**
+     * @brief Reads only the header of a PGM file
+     * @param imagePath Path to the PGM file
+     * @param info Receives format, dimensions, maximum value and data offset
+     * @return true if the file starts with a complete P2 or P5 header, false otherwise
+     * @details Reads a single block from the start of the file; the raster is not touched
+     */
+    static bool probe(const std::string& imagePath, PGMInfo& info);
+
+    /**
+     * @brief Loads a P5 PGM image reduced by an integer factor
+     * @param imagePath Path to the P5 PGM image file
+     * @param factor Reduction factor (1 loads the full image)
+     * @param average true to average factor x factor blocks, false to keep every factor-th pixel (default: true)
+     * @return true if loading was successful, false otherwise
+     * @details The result is ceil(width / factor) x ceil(height / factor); only the rows
+     *          needed are read, and the full-resolution raster is never held in memory
+     */
+    bool loadScaled(const std::string& imagePath, unsigned int factor, bool average = true);
+
     /**
      * @brief Saves the image to a P5 (binary) PGM file
      * @param imagePath Path where to save the P5 PGM image
@@ -76,6 +108,31 @@ public:
      */
     bool save(std::string imagePath);
 
+    /**
+     * @brief Saves the image to a P5 PGM file with parallel positional writes
+     * @param imagePath Path where to save the P5 PGM image
+     * @param direct true to bypass the page cache with O_DIRECT (default: false)
+     * @return true if saving was successful, false otherwise
+     * @details Produces the same file as save()
+     */
+    bool saveParallel(const std::string& imagePath, bool direct = false) const;
+
+    /**
+     * @brief Writes a P5 PGM file whose rows are produced band by band in parallel
+     * @param imagePath Path where to save the P5 PGM image
+     * @param width Width of the image
+     * @param height Height of the image
+     * @param producer Called as producer(y0, y1, rows) to fill rows y0..y1-1 into rows,
+     *                 width bytes per row; called concurrently for different bands
+     * @param direct true to bypass the page cache with O_DIRECT (default: false)
+     * @return true if saving was successful, false otherwise
+     * @details Each band is written as soon as it is produced, so output is never held
+     *          up by the slowest band and the full raster never has to exist in memory
+     */
+    static bool saveBands(const std::string& imagePath, unsigned int width, unsigned int height,
+                          const std::function<void(unsigned int, unsigned int, unsigned char*)>& producer,
+                          bool direct = false);
+
     /**
      * @brief Checks if the image is empty
      * @return true if image has no data, false otherwise
@@ -0,0 +1,54 @@
+#include "ImageBatch.h"
+#include <algorithm>
+
+/**
+ * @brief Packs images into a batch
+ * @param images Images of equal size
+ * @return true if successful
+ */
+bool ImageBatch::pack(const std::vector<Image>& images) {
+    *this = ImageBatch();
+    if (images.empty()) {
+        return true;
+    }
+
+    for (const Image& img : images) {
+        if (img.width() != images[0].width() || img.height() != images[0].height()) {
+            return false;
+        }
+    }
+
+    *this = ImageBatch(static_cast<unsigned int>(images.size()), images[0].width(), images[0].height());
+    for (unsigned int i = 0; i < m_count; ++i) {
+        set(i, images[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief Copies one image out of the batch
+ * @param i Image index
+ * @param dst Destination image
+ */
+void ImageBatch::unpack(unsigned int i, Image& dst) const {
+    dst = Image(m_width, m_height);
+    for (unsigned int y = 0; y < m_height; ++y) {
+        std::copy(row(i, y), row(i, y) + m_width, dst.row(y));
+    }
+}
+
+/**
+ * @brief Copies an image into the batch
+ * @param i Image index
+ * @param src Source image
+ * @return true if successful
+ */
+bool ImageBatch::set(unsigned int i, const Image& src) {
+    if (i >= m_count || src.width() != m_width || src.height() != m_height) {
+        return false;
+    }
+    for (unsigned int y = 0; y < m_height; ++y) {
+        std::copy(src.row(y), src.row(y) + m_width, row(i, y));
+    }
+    return true;
+}
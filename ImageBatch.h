@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Image.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Class storing many grayscale images of equal size in one contiguous block
+ * @details Image i occupies bytes [i * width * height, (i + 1) * width * height),
+ *          row after row. Batched operations sweep the whole block at once, so the
+ *          per-image cost of allocation and setup disappears for small images.
+ */
+class ImageBatch {
+private:
+    std::vector<unsigned char> m_data;  ///< Pixel values, image after image
+    unsigned int m_count;               ///< Number of images
+    unsigned int m_width;               ///< Width of every image
+    unsigned int m_height;              ///< Height of every image
+
+public:
+    /**
+     * @brief Default constructor
+     * @details Creates an empty batch
+     */
+    ImageBatch() : m_count(0), m_width(0), m_height(0) {}
+
+    /**
+     * @brief Constructor with dimensions
+     * @param count Number of images
+     * @param w Width of every image
+     * @param h Height of every image
+     * @details All pixels are initialized to 0
+     */
+    ImageBatch(unsigned int count, unsigned int w, unsigned int h)
+        : m_data(static_cast<size_t>(count) * w * h), m_count(count), m_width(w), m_height(h) {}
+
+    /**
+     * @brief Packs images into a batch
+     * @param images Images of equal size
+     * @return true if successful, false if the sizes differ (the batch is then empty)
+     */
+    bool pack(const std::vector<Image>& images);
+
+    /**
+     * @brief Copies one image out of the batch
+     * @param i Image index
+     * @param dst Destination image
+     */
+    void unpack(unsigned int i, Image& dst) const;
+
+    /**
+     * @brief Copies an image into the batch
+     * @param i Image index
+     * @param src Source image with the batch dimensions
+     * @return true if successful, false if the dimensions differ
+     */
+    bool set(unsigned int i, const Image& src);
+
+    /**
+     * @brief Gets the number of images
+     * @return Number of images
+     */
+    unsigned int count() const { return m_count; }
+
+    /**
+     * @brief Gets the width of every image
+     * @return Width in pixels
+     */
+    unsigned int width() const { return m_width; }
+
+    /**
+     * @brief Gets the height of every image
+     * @return Height in pixels
+     */
+    unsigned int height() const { return m_height; }
+
+    /**
+     * @brief Checks if the batch is empty
+     * @return true if the batch holds no pixels
+     */
+    bool isEmpty() const { return m_data.empty(); }
+
+    /**
+     * @brief Gets the number of pixels of one image
+     * @return width * height
+     */
+    size_t imageSize() const { return static_cast<size_t>(m_width) * m_height; }
+
+    /**
+     * @brief Gets the pixels of one image
+     * @param i Image index
+     * @return Pointer to the first pixel of image i
+     */
+    unsigned char* image(unsigned int i) { return m_data.data() + i * imageSize(); }
+    const unsigned char* image(unsigned int i) const { return m_data.data() + i * imageSize(); }
+
+    /**
+     * @brief Gets one row of one image
+     * @param i Image index
+     * @param y Row index
+     * @return Pointer to the first pixel of the row
+     */
+    unsigned char* row(unsigned int i, unsigned int y) { return image(i) + static_cast<size_t>(y) * m_width; }
+    const unsigned char* row(unsigned int i, unsigned int y) const { return image(i) + static_cast<size_t>(y) * m_width; }
+
+    /**
+     * @brief Accesses a pixel
+     * @param i Image index
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @return Reference to the pixel value
+     */
+    unsigned char& at(unsigned int i, unsigned int x, unsigned int y) { return row(i, y)[x]; }
+    const unsigned char& at(unsigned int i, unsigned int x, unsigned int y) const { return row(i, y)[x]; }
+
+    /**
+     * @brief Gets all pixels of the batch
+     * @return Pointer to the first pixel of image 0
+     */
+    unsigned char* data() { return m_data.data(); }
+    const unsigned char* data() const { return m_data.data(); }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Class representing a single channel image with an arbitrary pixel type
+ * @details Used for high bit-depth intermediates (16-bit, float) that are later reduced
+ *          to an 8-bit Image. Pixels are stored contiguously in row-major order.
+ */
+template <typename T>
+class ImageBuffer {
+private:
+    std::vector<T> m_data;   ///< Pixel values, row after row
+    unsigned int m_width;    ///< Width of the image
+    unsigned int m_height;   ///< Height of the image
+
+public:
+    /**
+     * @brief Default constructor
+     * @details Creates an empty buffer
+     */
+    ImageBuffer() : m_width(0), m_height(0) {}
+
+    /**
+     * @brief Constructor with dimensions
+     * @param w Width of the image
+     * @param h Height of the image
+     * @param value Initial value of every pixel
+     */
+    ImageBuffer(unsigned int w, unsigned int h, T value = T())
+        : m_data(static_cast<size_t>(w) * h, value), m_width(w), m_height(h) {}
+
+    /**
+     * @brief Gets the width of the image
+     * @return Width in pixels
+     */
+    unsigned int width() const { return m_width; }
+
+    /**
+     * @brief Gets the height of the image
+     * @return Height in pixels
+     */
+    unsigned int height() const { return m_height; }
+
+    /**
+     * @brief Checks if the buffer is empty
+     * @return true if buffer has no pixels
+     */
+    bool isEmpty() const { return m_data.empty(); }
+
+    /**
+     * @brief Accesses a pixel at specified coordinates
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @return Reference to the pixel value
+     */
+    T& at(unsigned int x, unsigned int y) { return m_data[static_cast<size_t>(y) * m_width + x]; }
+
+    /**
+     * @brief Accesses a pixel at specified coordinates (const version)
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @return Const reference to the pixel value
+     */
+    const T& at(unsigned int x, unsigned int y) const { return m_data[static_cast<size_t>(y) * m_width + x]; }
+
+    /**
+     * @brief Gets a row of pixels
+     * @param y Row index
+     * @return Pointer to the first pixel in the row
+     */
+    T* row(unsigned int y) { return m_data.data() + static_cast<size_t>(y) * m_width; }
+
+    /**
+     * @brief Gets a row of pixels (const version)
+     * @param y Row index
+     * @return Const pointer to the first pixel in the row
+     */
+    const T* row(unsigned int y) const { return m_data.data() + static_cast<size_t>(y) * m_width; }
+
+    /**
+     * @brief Gets the whole pixel array
+     * @return Pointer to the first pixel
+     */
+    T* data() { return m_data.data(); }
+
+    /**
+     * @brief Gets the whole pixel array (const version)
+     * @return Const pointer to the first pixel
+     */
+    const T* data() const { return m_data.data(); }
+};
+
+using Image16 = ImageBuffer<unsigned short>; ///< 16-bit grayscale image (e.g. scanner or medical data)
+using ImageF = ImageBuffer<float>;           ///< Floating point grayscale image for intermediates
@@ -1,6 +1,127 @@
 #include "ImageProcessing.h"
+#include "Parallel.h"
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Tabulates the operation for all 256 gray values
+ * @return Lookup table with lut[v] == apply(v)
+ */
+std::array<unsigned char, 256> PointOperation::lookupTable() const {
+    std::array<unsigned char, 256> lut;
+    for (int v = 0; v < 256; ++v) {
+        lut[v] = apply(static_cast<unsigned char>(v));
+    }
+    return lut;
+}
+
+/**
+ * @brief Tabulates the operation for a given source image
+ * @return Lookup table of the operation, independent of the image
+ */
+std::array<unsigned char, 256> PointOperation::lookupTable(const Image&) const {
+    return lookupTable();
+}
+
+/**
+ * @brief Process the grayscale image by applying the lookup table
+ * @param src Source image
+ * @param dst Destination image
+ * @details apply() is evaluated only 256 times, then every pixel is a table lookup.
+ *          Row bands are processed in parallel
+ */
+void PointOperation::process(const Image& src, Image& dst) {
+    std::array<unsigned char, 256> lut = lookupTable(src);
+    dst = Image(src.width(), src.height()); // Empty image
+
+    unsigned int width = src.width();
+    Parallel::forRange(src.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned char* in = src.row(y);
+            unsigned char* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = lut[in[x]];
+            }
+        }
+    });
+}
+
+/**
+ * @brief Applies the lookup table to every image of a batch
+ * @param src Source batch
+ * @param dst Destination batch
+ * @details The batch is one contiguous block, so it is swept as a single array
+ *          split into parallel chunks, without any per-image setup. Content-dependent
+ *          operations are tabulated and applied image by image instead
+ */
+void PointOperation::process(const ImageBatch& src, ImageBatch& dst) {
+    dst = ImageBatch(src.count(), src.width(), src.height());
+    if (isContentDependent()) {
+        Image img;
+        for (unsigned int i = 0; i < src.count(); ++i) {
+            src.unpack(i, img);
+            std::array<unsigned char, 256> lut = lookupTable(img);
+            const unsigned char* in = src.image(i);
+            unsigned char* out = dst.image(i);
+            for (size_t k = 0; k < src.imageSize(); ++k) {
+                out[k] = lut[in[k]];
+            }
+        }
+        return;
+    }
+
+    std::array<unsigned char, 256> lut = lookupTable();
+
+    const size_t chunk = 1 << 16;
+    size_t total = src.count() * src.imageSize();
+    const unsigned char* in = src.data();
+    unsigned char* out = dst.data();
+    Parallel::forRange(static_cast<unsigned int>((total + chunk - 1) / chunk), [&](unsigned int begin, unsigned int end) {
+        size_t last = std::min(total, end * chunk);
+        for (size_t i = begin * chunk; i < last; ++i) {
+            out[i] = lut[in[i]];
+        }
+    }, 1);
+}
+
+/**
+ * @brief Constructor for a point operation chain
+ * @details Starts with the identity table
+ */
+PointOperationChain::PointOperationChain() {
+    for (int v = 0; v < 256; ++v) {
+        lut[v] = static_cast<unsigned char>(v);
+    }
+}
+
+/**
+ * @brief Appends an operation to the chain
+ * @param op Operation applied after the ones already in the chain
+ * @return Reference to this chain
+ * @throws std::invalid_argument if op is content-dependent
+ * @details Composes op into the table: lut[v] = op(lut[v])
+ */
+PointOperationChain& PointOperationChain::then(const PointOperation& op) {
+    if (op.isContentDependent()) {
+        throw std::invalid_argument("PointOperationChain: content-dependent operations cannot be composed");
+    }
+    std::array<unsigned char, 256> next = op.lookupTable();
+    for (int v = 0; v < 256; ++v) {
+        lut[v] = next[lut[v]];
+    }
+    return *this;
+}
+
+/**
+ * @brief Maps a single gray value through the whole chain
+ * @param value Source gray value
+ * @return Resulting gray value
+ */
+unsigned char PointOperationChain::apply(unsigned char value) const {
+    return lut[value];
+}
 
 /**
  * @brief Constructor for brightness and contrast adjustment
@@ -11,23 +132,14 @@ BrightnessContrastAdjustment::BrightnessContrastAdjustment(double alpha, int bet
     : alpha(alpha), beta(beta) {}
 
 /**
- * @brief Process the grayscale image to adjust brightness and contrast
- * @param src Source  image
- * @param dst Destination  image
+ * @brief Adjusts brightness and contrast of a single gray value
+ * @param value Source gray value
+ * @return Adjusted gray value
  * @details Applies formula: new_value = alpha * old_value + beta
  *          Clamps results to [0,255] range for values
  */
-void BrightnessContrastAdjustment::process(const Image& src, Image& dst) {
-    dst = Image(src.width(), src.height()); // Empty image
-    
-    for (unsigned int y = 0; y < src.height(); ++y) {
-        for (unsigned int x = 0; x < src.width(); ++x) {
-            unsigned char srcPixel = src.at(x, y); // Get pixel
-            unsigned char& dstPixel = dst.at(x, y); // Reference the pixel of the new photo
-            
-            dstPixel = std::min(255, std::max(0, static_cast<int>(srcPixel * alpha + beta))); // alpha for contrast , beta for brightness, min() ensures we stay in the range (0,255)
-        }
-    }
+unsigned char BrightnessContrastAdjustment::apply(unsigned char value) const {
+    return std::min(255, std::max(0, static_cast<int>(value * alpha + beta))); // alpha for contrast , beta for brightness, min() ensures we stay in the range (0,255)
 }
 
 /**
@@ -38,23 +150,14 @@ void BrightnessContrastAdjustment::process(const Image& src, Image& dst) {
 GammaCorrection::GammaCorrection(double gamma) : gamma(gamma) {}
 
 /**
- * @brief Process the grayscale image to apply gamma correction
- * @param src Source image
- * @param dst Destination image
+ * @brief Applies gamma correction to a single gray value
+ * @param value Source gray value
+ * @return Corrected gray value
  * @details Applies formula: new_value = 255 * (old_value/255)^gamma
  *          Clamps results to [0,255] range for values
  */
-void GammaCorrection::process(const Image& src, Image& dst) {
-    dst = Image(src.width(), src.height()); // eEmpty image
-    
-    for (unsigned int y = 0; y < src.height(); ++y) {
-        for (unsigned int x = 0; x < src.width(); ++x) {
-            unsigned char srcPixel = src.at(x, y); // Get pixel from source image
-            unsigned char& dstPixel = dst.at(x, y); // Destination pixel
-            
-            dstPixel = std::min(255, static_cast<int>(255 * pow(srcPixel / 255.0, gamma))); // gamma<1 brigtens dark regions while >1 darkens bright regions
-        }
-    }
+unsigned char GammaCorrection::apply(unsigned char value) const {
+    return std::min(255, static_cast<int>(255 * pow(value / 255.0, gamma))); // gamma<1 brigtens dark regions while >1 darkens bright regions
 }
 
 /**
@@ -114,4 +217,66 @@ void Convolution::process(const Image& src, Image& dst) {
             dstPixel = std::min(255, std::max(0, static_cast<int>(scalingFunction(sum)))); // Change the pixel with the new one by applying the scaling function of sum
         }
     }
-} 
\ No newline at end of file
+}
+
+/**
+ * @brief Convolves every image of a batch
+ * @param src Source batch
+ * @param dst Destination batch
+ * @details The kernel is flattened once for the whole batch and the rows of all images
+ *          are processed in parallel. Pixels whose kernel lies fully inside the image
+ *          skip the bounds checks; the summation order matches process(), so results
+ *          are bit-identical
+ */
+void Convolution::process(const ImageBatch& src, ImageBatch& dst) {
+    dst = ImageBatch(src.count(), src.width(), src.height());
+
+    std::vector<double> k(static_cast<size_t>(kernelWidth) * kernelHeight);
+    for (int ky = 0; ky < kernelHeight; ++ky) {
+        std::copy(kernel[ky], kernel[ky] + kernelWidth, &k[static_cast<size_t>(ky) * kernelWidth]);
+    }
+
+    int width = src.width();
+    int height = src.height();
+    int kernelRadiusX = kernelWidth / 2;
+    int kernelRadiusY = kernelHeight / 2;
+    int innerBegin = std::min(width, kernelRadiusX);
+    int innerEnd = std::max(innerBegin, width - (kernelWidth - 1 - kernelRadiusX));
+
+    Parallel::forRange(src.count() * src.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int r = begin; r < end; ++r) {
+            unsigned int i = r / height;
+            int y = r % height;
+            unsigned char* out = dst.row(i, y);
+            bool innerRow = y - kernelRadiusY >= 0 && y - kernelRadiusY + kernelHeight <= height;
+
+            for (int x = 0; x < width; ++x) {
+                double sum = 0.0;
+                if (innerRow && x >= innerBegin && x < innerEnd) {
+                    for (int ky = 0; ky < kernelHeight; ++ky) {
+                        const unsigned char* in = src.row(i, y + ky - kernelRadiusY) + x - kernelRadiusX;
+                        const double* kr = &k[static_cast<size_t>(ky) * kernelWidth];
+                        for (int kx = 0; kx < kernelWidth; ++kx) {
+                            sum += in[kx] * kr[kx];
+                        }
+                    }
+                } else {
+                    for (int ky = 0; ky < kernelHeight; ++ky) {
+                        int srcY = y + ky - kernelRadiusY;
+                        if (srcY < 0 || srcY >= height) {
+                            continue;
+                        }
+                        const unsigned char* in = src.row(i, srcY);
+                        for (int kx = 0; kx < kernelWidth; ++kx) {
+                            int srcX = x + kx - kernelRadiusX;
+                            if (srcX >= 0 && srcX < width) {
+                                sum += in[srcX] * k[static_cast<size_t>(ky) * kernelWidth + kx];
+                            }
+                        }
+                    }
+                }
+                out[x] = std::min(255, std::max(0, static_cast<int>(scalingFunction(sum))));
+            }
+        }
+    });
+}
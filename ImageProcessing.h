@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Image.h"
+#include "ImageBatch.h"
 #include <functional>
+#include <array>
 
 /**
  * @brief Abstract base class for grayscale image processing operations
@@ -22,11 +24,99 @@ public:
     virtual void process(const Image& src, Image& dst) = 0;
 };
 
+/**
+ * @brief Abstract base class for point operations
+ * @details A point operation maps every gray value independently of its position,
+ *          so it can be tabulated once into a 256-entry lookup table and applied
+ *          with a single table lookup per pixel. Point operations can be fused
+ *          into one table with PointOperationChain.
+ */
+class PointOperation : public ImageProcessing {
+public:
+    /**
+     * @brief Checks if the mapping depends on the image it is applied to
+     * @return true for operations such as histogram matching, false by default
+     * @details Content-dependent operations cannot be tabulated without a source image,
+     *          so they cannot be fused into a PointOperationChain or ToneMapping
+     */
+    virtual bool isContentDependent() const { return false; }
+
+    /**
+     * @brief Tabulates the operation for a given source image
+     * @param src Source grayscale image the table will be applied to
+     * @return Lookup table; the default ignores src and returns lookupTable()
+     * @details Operations whose mapping depends on the image content override it
+     */
+    virtual std::array<unsigned char, 256> lookupTable(const Image& src) const;
+
+    /**
+     * @brief Maps a single gray value
+     * @param value Source gray value
+     * @return Resulting gray value
+     */
+    virtual unsigned char apply(unsigned char value) const = 0;
+
+    /**
+     * @brief Tabulates the operation for all 256 gray values
+     * @return Lookup table with lut[v] == apply(v)
+     */
+    std::array<unsigned char, 256> lookupTable() const;
+
+    /**
+     * @brief Process the grayscale image by applying the lookup table
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     */
+    void process(const Image& src, Image& dst) override;
+
+    /**
+     * @brief Applies the lookup table to every image of a batch
+     * @param src Source batch
+     * @param dst Destination batch with the dimensions of src
+     * @details Content-dependent operations get a table per image, all others one
+     *          table for the whole batch
+     */
+    void process(const ImageBatch& src, ImageBatch& dst);
+};
+
+/**
+ * @brief Class for fusing several point operations into one
+ * @details Each added operation is composed into a single lookup table, so a chain
+ *          of any length costs one table lookup per pixel
+ */
+class PointOperationChain : public PointOperation {
+private:
+    std::array<unsigned char, 256> lut;  ///< Composed lookup table
+
+public:
+    /**
+     * @brief Constructor
+     * @details Creates the identity chain
+     */
+    PointOperationChain();
+
+    /**
+     * @brief Appends an operation to the chain
+     * @param op Operation applied after the ones already in the chain
+     * @return Reference to this chain
+     * @throws std::invalid_argument if op is content-dependent, since its table needs the
+     *         image it is applied to
+     */
+    PointOperationChain& then(const PointOperation& op);
+
+    /**
+     * @brief Maps a single gray value through the whole chain
+     * @param value Source gray value
+     * @return Resulting gray value
+     */
+    unsigned char apply(unsigned char value) const override;
+};
+
 /**
  * @brief Class for adjusting brightness and contrast of a grayscale image
  * @details Applies linear transformation to grayscale pixel values
  */
-class BrightnessContrastAdjustment : public ImageProcessing {
+class BrightnessContrastAdjustment : public PointOperation {
 private:
     double alpha;  ///< Contrast adjustment factor
     int beta;      ///< Brightness adjustment value
@@ -40,18 +130,18 @@ public:
     BrightnessContrastAdjustment(double alpha = 1.0, int beta = 0);
 
     /**
-     * @brief Process the grayscale image to adjust brightness and contrast
-     * @param src Source grayscale image
-     * @param dst Destination grayscale image
+     * @brief Adjusts brightness and contrast of a single gray value
+     * @param value Source gray value
+     * @return Adjusted gray value
      */
-    void process(const Image& src, Image& dst) override;
+    unsigned char apply(unsigned char value) const override;
 };
 
 /**
  * @brief Class for applying gamma correction to a grayscale image
  * @details Adjusts the brightness of a grayscale image using a power function
  */
-class GammaCorrection : public ImageProcessing {
+class GammaCorrection : public PointOperation {
 private:
     double gamma;  ///< Gamma correction factor
 
@@ -63,11 +153,11 @@ public:
     GammaCorrection(double gamma = 1.0);
 
     /**
-     * @brief Process the grayscale image to apply gamma correction
-     * @param src Source grayscale image
-     * @param dst Destination grayscale image
+     * @brief Applies gamma correction to a single gray value
+     * @param value Source gray value
+     * @return Corrected gray value
      */
-    void process(const Image& src, Image& dst) override;
+    unsigned char apply(unsigned char value) const override;
 };
 
 /**
@@ -104,6 +194,14 @@ public:
      */
     void process(const Image& src, Image& dst) override;
 
+    /**
+     * @brief Convolves every image of a batch
+     * @param src Source batch
+     * @param dst Destination batch with the dimensions of src
+     * @details Gives the same result as process() on each image separately
+     */
+    void process(const ImageBatch& src, ImageBatch& dst);
+
     // Delete copy constructor and assignment operator to prevent double-free
     Convolution(const Convolution&) = delete;
     Convolution& operator=(const Convolution&) = delete;
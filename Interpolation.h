@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Image.h"
+#include <algorithm>
+
+/**
+ * @brief Namespace containing shared pixel sampling helpers for geometric transforms
+ */
+namespace Interpolation {
+    /**
+     * @brief Samples a grayscale image bilinearly in 8-bit fixed point
+     * @param src Source grayscale image
+     * @param sx Integer X of the top-left neighbour (must be inside the image)
+     * @param sy Integer Y of the top-left neighbour (must be inside the image)
+     * @param fx Fractional X in 1/256 pixels
+     * @param fy Fractional Y in 1/256 pixels
+     * @return Blended gray value, neighbours past the last row/column are clamped to the edge
+     */
+    inline unsigned char bilinear(const Image& src, unsigned int sx, unsigned int sy, unsigned int fx, unsigned int fy) {
+        unsigned int nx = std::min(sx + 1, src.width() - 1);
+        const unsigned char* r0 = src.row(sy);
+        const unsigned char* r1 = src.row(std::min(sy + 1, src.height() - 1));
+
+        unsigned int top = r0[sx] * (256 - fx) + r0[nx] * fx;
+        unsigned int bottom = r1[sx] * (256 - fx) + r1[nx] * fx;
+        return static_cast<unsigned char>((top * (256 - fy) + bottom * fy + 32768) >> 16);
+    }
+}
@@ -0,0 +1,97 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Constructor
+ */
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+/**
+ * @brief Gets the bucket of a value
+ * @param value Value
+ * @return Bucket index
+ * @details For value >= 128 with highest set bit e, the value is shifted right by
+ *          e - 6, leaving a mantissa in [64, 128); buckets of shift s start at 64 (s + 1)
+ */
+unsigned int LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < 128) {
+        return static_cast<unsigned int>(value);
+    }
+    unsigned int e = 63 - static_cast<unsigned int>(__builtin_clzll(value));
+    unsigned int shift = e - 6;
+    return shift * 64 + static_cast<unsigned int>(value >> shift);
+}
+
+/**
+ * @brief Gets the largest value of a bucket
+ * @param bucket Bucket index
+ * @return Upper bound of the bucket
+ */
+uint64_t LatencyHistogram::bucketLimit(unsigned int bucket) {
+    if (bucket < 128) {
+        return bucket;
+    }
+    unsigned int shift = bucket / 64 - 1;
+    uint64_t mantissa = bucket - shift * 64;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+/**
+ * @brief Records a value
+ * @param value Value
+ */
+void LatencyHistogram::record(uint64_t value) {
+    ++counts[bucketOf(value)];
+    ++total;
+    sum += value;
+    maximum = std::max(maximum, value);
+}
+
+/**
+ * @brief Adds all values of another histogram
+ * @param other Histogram to add
+ */
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (unsigned int b = 0; b < bucketCount; ++b) {
+        counts[b] += other.counts[b];
+    }
+    total += other.total;
+    sum += other.sum;
+    maximum = std::max(maximum, other.maximum);
+}
+
+/**
+ * @brief Removes all values
+ */
+void LatencyHistogram::reset() {
+    counts.fill(0);
+    total = 0;
+    sum = 0;
+    maximum = 0;
+}
+
+/**
+ * @brief Gets the value below which a fraction of the recorded values lie
+ * @param percentile Percentile in [0, 100]
+ * @return Upper bound of the bucket holding the percentile
+ * @details The bound is capped at the largest recorded value
+ */
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::min(100.0, std::max(0.0, percentile)) / 100.0 * total));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (unsigned int b = 0; b < bucketCount; ++b) {
+        seen += counts[b];
+        if (seen >= rank) {
+            return std::min(bucketLimit(b), maximum);
+        }
+    }
+    return maximum;
+}
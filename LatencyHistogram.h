@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Class recording a distribution of durations with bounded relative error
+ * @details Log-linear (HDR style) buckets: values below 128 are counted exactly, larger
+ *          values in 64 linear sub-buckets per power of two, so every recorded value is
+ *          known to within 1/64 (1.6%) from 1 ns up to hundreds of years. Recording is a
+ *          few integer instructions and never allocates. Histograms of different threads
+ *          are combined with merge().
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned int bucketCount = 128 + 57 * 64;  ///< Buckets covering all 64-bit values
+
+private:
+    std::array<uint64_t, bucketCount> counts;  ///< Number of values per bucket
+    uint64_t total;                            ///< Number of recorded values
+    uint64_t sum;                              ///< Sum of recorded values
+    uint64_t maximum;                          ///< Largest recorded value
+
+public:
+    /**
+     * @brief Constructor
+     * @details Creates an empty histogram
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Gets the bucket of a value
+     * @param value Value
+     * @return Bucket index
+     */
+    static unsigned int bucketOf(uint64_t value);
+
+    /**
+     * @brief Gets the largest value of a bucket
+     * @param bucket Bucket index
+     * @return Upper bound of the values counted in the bucket
+     */
+    static uint64_t bucketLimit(unsigned int bucket);
+
+    /**
+     * @brief Records a value
+     * @param value Value, e.g. a latency in nanoseconds
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief Adds all values of another histogram
+     * @param other Histogram to add
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Removes all values
+     */
+    void reset();
+
+    /**
+     * @brief Gets the value below which a fraction of the recorded values lie
+     * @param percentile Percentile in [0, 100]
+     * @return Upper bound of the bucket holding the percentile, 0 if empty
+     */
+    uint64_t percentile(double percentile) const;
+
+    /**
+     * @brief Gets the number of recorded values
+     * @return Number of values
+     */
+    uint64_t count() const { return total; }
+
+    /**
+     * @brief Gets the mean of the recorded values
+     * @return Mean value, 0 if empty
+     */
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    /**
+     * @brief Gets the largest recorded value
+     * @return Largest value
+     */
+    uint64_t max() const { return maximum; }
+
+    /**
+     * @brief Gets the number of values in a bucket
+     * @param bucket Bucket index
+     * @return Number of values
+     */
+    uint64_t bucket(unsigned int bucket) const { return counts[bucket]; }
+};
@@ -0,0 +1,313 @@
+/**
+ * @file LoadGenerator.cpp
+ * @brief Open-loop load generator and latency benchmark for the image operators
+ * @details Usage: LoadGenerator [rate] [seconds] [workers] [seed] [metrics file]
+ *          Requests are drawn from a weighted mix of operator chains and image sizes and
+ *          issued on a fixed schedule (Poisson arrivals at the target rate), independent
+ *          of how fast they complete. A pool of worker threads serves them. Latency is
+ *          measured from the scheduled arrival time, so time spent queued behind slow
+ *          requests is counted (no coordinated omission). Results are reported per
+ *          scenario as p50/p99/p99.9/max latency and achieved throughput. With a metrics
+ *          file, request, pixel and error counters, the queue depth and latency histograms
+ *          are exported in Prometheus text format every second.
+ */
+
+#include "Dithering.h"
+#include "ImageBatch.h"
+#include "ImageProcessing.h"
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+#include "PixelExpression.h"
+#include "Random.h"
+#include "Synthetic.h"
+#include "WarpPerspective.h"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Structure describing one kind of request
+ */
+struct Scenario {
+    std::string name;                                        ///< Name shown in the report
+    unsigned int weight;                                     ///< Relative frequency in the mix
+    Image input;                                             ///< Input image
+    std::function<void(const Image&, Image&)> run;           ///< Operator chain serving the request
+};
+
+/**
+ * @brief Structure holding the exported metrics of one scenario
+ */
+struct ScenarioMetrics {
+    Metrics::Counter requests;   ///< Completed requests
+    Metrics::Counter pixels;     ///< Input pixels processed
+    Metrics::Counter errors;     ///< Requests producing an empty result
+    Metrics::Histogram latency;  ///< Latency from scheduled arrival to completion
+
+    /**
+     * @brief Constructor
+     * @param name Scenario name used as operator label
+     */
+    ScenarioMetrics(const std::string& name)
+        : requests("imageprocessing_requests_total", "Completed requests", Metrics::label("operator", name)),
+          pixels("imageprocessing_pixels_total", "Input pixels processed", Metrics::label("operator", name)),
+          errors("imageprocessing_errors_total", "Requests that failed", Metrics::label("operator", name)),
+          latency("imageprocessing_request_latency_seconds", "Latency from scheduled arrival to completion",
+                  Metrics::Histogram::latencyBounds(), Metrics::label("operator", name)) {}
+};
+
+/**
+ * @brief Structure holding one scheduled request
+ */
+struct Request {
+    unsigned int scenario;    ///< Index of the scenario
+    Clock::time_point due;    ///< Scheduled arrival time
+};
+
+/**
+ * @brief Creates a synthetic input image
+ * @param pattern Content of the image
+ * @param size Width and height
+ * @return Generated image
+ */
+Image makeInput(SyntheticSpec::Pattern pattern, unsigned int size) {
+    SyntheticSpec spec;
+    spec.pattern = pattern;
+    spec.width = spec.height = size;
+    spec.seed = size;
+    return Synthetic::generate(spec);
+}
+
+/**
+ * @brief Builds the request mix
+ * @return Scenarios with their inputs and operator chains
+ */
+std::vector<Scenario> makeScenarios() {
+    std::vector<Scenario> scenarios;
+
+    scenarios.push_back({"tone 256x256", 40, makeInput(SyntheticSpec::Pattern::Gradient, 256),
+        [](const Image& src, Image& dst) {
+            PointOperationChain chain;
+            chain.then(GammaCorrection(0.8)).then(BrightnessContrastAdjustment(1.2, -10));
+            chain.process(src, dst);
+        }});
+
+    scenarios.push_back({"blur 512x512", 25, makeInput(SyntheticSpec::Pattern::Shapes, 512),
+        [](const Image& src, Image& dst) {
+            double** kernel = new double*[3] {
+                new double[3]{1.0/16, 2.0/16, 1.0/16},
+                new double[3]{2.0/16, 4.0/16, 2.0/16},
+                new double[3]{1.0/16, 2.0/16, 1.0/16}
+            };
+            Convolution blur(kernel, 3, 3, [](double v) { return v; });
+            blur.process(src, dst);
+        }});
+
+    scenarios.push_back({"expression 1024x1024", 10, makeInput(SyntheticSpec::Pattern::Noise, 1024),
+        [](const Image& src, Image& dst) {
+            PixelExpression expr("clamp((a - 128) * 1.5 + 128)");
+            expr.process(src, dst);
+        }});
+
+    scenarios.push_back({"dither 256x256", 10, makeInput(SyntheticSpec::Pattern::Gradient, 256),
+        [](const Image& src, Image& dst) {
+            FloydSteinbergDithering(2).process(src, dst);
+        }});
+
+    scenarios.push_back({"warp 512x512", 10, makeInput(SyntheticSpec::Pattern::Text, 512),
+        [](const Image& src, Image& dst) {
+            double a = 5.0 * 3.14159265358979323846 / 180.0;
+            std::array<double, 9> rotation = {std::cos(a), -std::sin(a), 20, std::sin(a), std::cos(a), -20, 0, 0, 1};
+            WarpPerspective(rotation, src.width(), src.height(), 255).process(src, dst);
+        }});
+
+    scenarios.push_back({"thumbnails 64x(64x64)", 5, makeInput(SyntheticSpec::Pattern::Checkerboard, 64),
+        [](const Image& src, Image& dst) {
+            ImageBatch batch(64, src.width(), src.height()), out;
+            for (unsigned int i = 0; i < batch.count(); ++i) {
+                batch.set(i, src);
+            }
+            GammaCorrection(1.5).process(batch, out);
+            out.unpack(0, dst);
+        }});
+
+    return scenarios;
+}
+
+/**
+ * @brief Formats nanoseconds as milliseconds
+ * @param ns Duration in nanoseconds
+ * @return Milliseconds
+ */
+double toMs(uint64_t ns) {
+    return ns / 1e6;
+}
+
+/**
+ * @brief Prints one report line
+ * @param name Scenario name
+ * @param h Latency histogram
+ */
+void printLine(const std::string& name, const LatencyHistogram& h) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << h.count()
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << toMs(h.percentile(50)) << std::setw(10) << toMs(h.percentile(99))
+              << std::setw(10) << toMs(h.percentile(99.9)) << std::setw(10) << toMs(h.max()) << "\n";
+}
+
+}
+
+/**
+ * @brief Main function running the load test
+ * @param argc Argument count
+ * @param argv Arguments: [rate] [seconds] [workers] [seed] [metrics file]
+ * @return 0 on success, 1 on invalid arguments
+ */
+int main(int argc, char** argv) {
+    double rate = argc > 1 ? std::strtod(argv[1], nullptr) : 100.0;
+    double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 10.0;
+    unsigned int workers = argc > 3 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1;
+    if (!(rate > 0) || !(seconds > 0) || workers == 0) {
+        std::cerr << "Usage: LoadGenerator [rate] [seconds] [workers] [seed] [metrics file]\n";
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios = makeScenarios();
+    unsigned int totalWeight = 0;
+    for (const Scenario& s : scenarios) {
+        totalWeight += s.weight;
+    }
+
+    std::vector<std::unique_ptr<ScenarioMetrics>> metrics;
+    for (const Scenario& s : scenarios) {
+        metrics.emplace_back(new ScenarioMetrics(s.name));
+    }
+    Metrics::Gauge queueDepth("imageprocessing_queue_depth", "Requests waiting for a worker");
+    std::unique_ptr<Metrics::Exporter> exporter;
+    if (argc > 5) {
+        exporter.reset(new Metrics::Exporter(argv[5], 1.0));
+    }
+
+    std::deque<Request> queue;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool finished = false;
+
+    // One latency and one service time histogram per worker and scenario, merged at the end
+    std::vector<std::vector<LatencyHistogram>> latency(workers, std::vector<LatencyHistogram>(scenarios.size()));
+    std::vector<LatencyHistogram> service(workers);
+
+    std::vector<std::thread> pool;
+    for (unsigned int w = 0; w < workers; ++w) {
+        pool.emplace_back([&, w]() {
+            Image dst;
+            while (true) {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&]() { return finished || !queue.empty(); });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    request = queue.front();
+                    queue.pop_front();
+                    queueDepth.set(static_cast<int64_t>(queue.size()));
+                }
+
+                const Scenario& s = scenarios[request.scenario];
+                Clock::time_point start = Clock::now();
+                s.run(s.input, dst);
+                Clock::time_point end = Clock::now();
+                uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - request.due).count();
+                latency[w][request.scenario].record(ns);
+
+                ScenarioMetrics& m = *metrics[request.scenario];
+                m.requests.add();
+                m.pixels.add(static_cast<uint64_t>(s.input.width()) * s.input.height());
+                if (dst.isEmpty()) {
+                    m.errors.add();
+                }
+                m.latency.observe(ns / 1e9);
+                service[w].record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+        });
+    }
+
+    // Open loop: arrivals follow the schedule no matter how far behind the workers are
+    Random::Generator rng(seed);
+    Clock::time_point begin = Clock::now();
+    Clock::time_point stop = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    Clock::time_point due = begin;
+    size_t issued = 0;
+    while (true) {
+        due += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-std::log(1.0 - rng.uniform()) / rate));
+        if (due >= stop) {
+            break;
+        }
+        unsigned int pick = rng.below(totalWeight);
+        unsigned int scenario = 0;
+        while (pick >= scenarios[scenario].weight) {
+            pick -= scenarios[scenario++].weight;
+        }
+
+        std::this_thread::sleep_until(due);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back({scenario, due});
+            queueDepth.set(static_cast<int64_t>(queue.size()));
+        }
+        ready.notify_one();
+        ++issued;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    ready.notify_all();
+    for (std::thread& t : pool) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    if (exporter) {
+        exporter->stop(); // Final write with the complete counts
+    }
+
+    LatencyHistogram all, serviceAll;
+    std::vector<LatencyHistogram> perScenario(scenarios.size());
+    for (unsigned int w = 0; w < workers; ++w) {
+        for (size_t s = 0; s < scenarios.size(); ++s) {
+            perScenario[s].merge(latency[w][s]);
+            all.merge(latency[w][s]);
+        }
+        serviceAll.merge(service[w]);
+    }
+
+    std::cout << "Target " << rate << " req/s for " << seconds << " s, " << workers << " workers, seed " << seed << "\n";
+    std::cout << "Issued " << issued << " requests, achieved " << std::fixed << std::setprecision(1)
+              << all.count() / elapsed << " req/s\n\n";
+    std::cout << std::left << std::setw(24) << "latency (ms)" << std::right << std::setw(8) << "count"
+              << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+    for (size_t s = 0; s < scenarios.size(); ++s) {
+        printLine(scenarios[s].name, perScenario[s]);
+    }
+    printLine("all", all);
+    printLine("service time (all)", serviceAll);
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief Structure holding all registered metrics
+ */
+struct Registry {
+    std::mutex mutex;                        ///< Protects metrics
+    std::vector<Metrics::Metric*> metrics;   ///< Registered metrics in creation order
+};
+
+/**
+ * @brief Gets the process-wide registry
+ * @return Registry
+ */
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/**
+ * @brief Writes the label set of a sample
+ * @param os Output stream
+ * @param labels Label pairs of the metric
+ * @param extra Additional label pair (may be empty)
+ */
+void writeLabels(std::ostream& os, const std::string& labels, const std::string& extra) {
+    if (labels.empty() && extra.empty()) {
+        return;
+    }
+    os << '{' << labels << (labels.empty() || extra.empty() ? "" : ",") << extra << '}';
+}
+
+}
+
+namespace Metrics {
+
+/**
+ * @brief Formats one label pair
+ * @param name Label name
+ * @param value Label value
+ * @return name="value" with the value escaped as the text format requires
+ */
+std::string label(const std::string& name, const std::string& value) {
+    std::string pair = name + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            pair += '\\';
+            pair += c;
+        } else if (c == '\n') {
+            pair += "\\n";
+        } else {
+            pair += c;
+        }
+    }
+    return pair + '"';
+}
+
+/**
+ * @brief Gets the slot of the calling thread
+ * @return Slot index
+ * @details Threads get consecutive slots in the order they first record something
+ */
+unsigned int threadSlot() {
+    static std::atomic<unsigned int> next{0};
+    thread_local unsigned int slot = next.fetch_add(1, std::memory_order_relaxed) % slotCount;
+    return slot;
+}
+
+/**
+ * @brief Constructor registering the metric
+ * @param name Metric name
+ * @param help Description
+ * @param labels Label pairs without braces
+ */
+Metric::Metric(const std::string& name, const std::string& help, const std::string& labels)
+    : m_name(name), m_help(help), m_labels(labels) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.metrics.push_back(this);
+}
+
+/**
+ * @brief Destructor unregistering the metric
+ */
+Metric::~Metric() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.metrics.erase(std::remove(r.metrics.begin(), r.metrics.end(), this), r.metrics.end());
+}
+
+/**
+ * @brief Constructor for a counter
+ * @param name Metric name
+ * @param help Description
+ * @param labels Label pairs without braces
+ */
+Counter::Counter(const std::string& name, const std::string& help, const std::string& labels)
+    : Metric(name, help, labels), slots(new Slot[slotCount]) {}
+
+/**
+ * @brief Gets the current value
+ * @return Sum over all threads
+ */
+uint64_t Counter::value() const {
+    uint64_t sum = 0;
+    for (unsigned int s = 0; s < slotCount; ++s) {
+        sum += slots[s].value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+/**
+ * @brief Writes the sample line of the counter
+ * @param os Output stream
+ */
+void Counter::write(std::ostream& os) const {
+    os << name();
+    writeLabels(os, labels(), "");
+    os << ' ' << value() << '\n';
+}
+
+/**
+ * @brief Constructor for a gauge
+ * @param name Metric name
+ * @param help Description
+ * @param labels Label pairs without braces
+ */
+Gauge::Gauge(const std::string& name, const std::string& help, const std::string& labels)
+    : Metric(name, help, labels), m_value(0) {}
+
+/**
+ * @brief Writes the sample line of the gauge
+ * @param os Output stream
+ */
+void Gauge::write(std::ostream& os) const {
+    os << name();
+    writeLabels(os, labels(), "");
+    os << ' ' << value() << '\n';
+}
+
+/**
+ * @brief Constructor for a histogram
+ * @param name Metric name
+ * @param help Description
+ * @param bounds Upper bounds of the buckets
+ * @param labels Label pairs without braces
+ * @details Each slot holds bounds.size() + 1 counts and the sum in whole 64-byte aligned
+ *          cache lines, so threads never share a line
+ */
+Histogram::Histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+                     const std::string& labels)
+    : Metric(name, help, labels), bounds(bounds),
+      linesPerSlot((static_cast<unsigned int>(bounds.size()) + 2 + 7) / 8),
+      lines(new Line[static_cast<size_t>(linesPerSlot) * slotCount]) {
+    for (size_t i = 0; i < static_cast<size_t>(linesPerSlot) * slotCount; ++i) {
+        for (std::atomic<uint64_t>& w : lines[i].word) {
+            w.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Records a value
+ * @param value Observed value
+ * @details The sum is kept in units of 1e-9 so it can be accumulated with an integer add
+ */
+void Histogram::observe(double value) {
+    unsigned int slot = threadSlot();
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    word(slot, bucket).fetch_add(1, std::memory_order_relaxed);
+    word(slot, bounds.size() + 1).fetch_add(static_cast<uint64_t>(std::max(0.0, value) * 1e9 + 0.5), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Gets bounds from 1 ms to about 16 s in powers of two
+ * @return Bucket bounds in seconds
+ */
+std::vector<double> Histogram::latencyBounds() {
+    std::vector<double> b;
+    for (double v = 0.001; v < 20.0; v *= 2) {
+        b.push_back(v);
+    }
+    return b;
+}
+
+/**
+ * @brief Writes the bucket, sum and count lines of the histogram
+ * @param os Output stream
+ */
+void Histogram::write(std::ostream& os) const {
+    std::vector<uint64_t> totals(bounds.size() + 2, 0);
+    for (unsigned int s = 0; s < slotCount; ++s) {
+        for (size_t i = 0; i < totals.size(); ++i) {
+            totals[i] += word(s, i).load(std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+        cumulative += totals[i];
+        std::ostringstream le;
+        if (i < bounds.size()) {
+            le << "le=\"" << bounds[i] << '"';
+        } else {
+            le << "le=\"+Inf\"";
+        }
+        os << name() << "_bucket";
+        writeLabels(os, labels(), le.str());
+        os << ' ' << cumulative << '\n';
+    }
+    os << name() << "_sum";
+    writeLabels(os, labels(), "");
+    os << ' ' << totals[bounds.size() + 1] / 1e9 << '\n';
+    os << name() << "_count";
+    writeLabels(os, labels(), "");
+    os << ' ' << cumulative << '\n';
+}
+
+/**
+ * @brief Writes all registered metrics in Prometheus text format
+ * @param os Output stream
+ * @details Metrics sharing a name are grouped under one HELP and TYPE line
+ */
+void writeText(std::ostream& os) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::vector<Metric*> sorted = r.metrics;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Metric* a, const Metric* b) {
+        return a->name() < b->name();
+    });
+
+    const std::string* previous = nullptr;
+    for (const Metric* m : sorted) {
+        if (previous == nullptr || *previous != m->name()) {
+            os << "# HELP " << m->name() << ' ';
+            for (char c : m->help()) { // Backslash and newline must be escaped in HELP text
+                if (c == '\\') {
+                    os << "\\\\";
+                } else if (c == '\n') {
+                    os << "\\n";
+                } else {
+                    os << c;
+                }
+            }
+            os << '\n';
+            os << "# TYPE " << m->name() << ' ' << m->type() << '\n';
+            previous = &m->name();
+        }
+        m->write(os);
+    }
+}
+
+/**
+ * @brief Writes all registered metrics to a file
+ * @param path Output file path
+ * @return true if successful
+ */
+bool writeFile(const std::string& path) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp);
+        if (!file.is_open()) {
+            return false;
+        }
+        writeText(file);
+        if (!file) {
+            return false;
+        }
+    }
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+/**
+ * @brief Constructor starting the background thread
+ * @param path Output file path
+ * @param interval Seconds between writes
+ */
+Exporter::Exporter(const std::string& path, double interval)
+    : path(path), interval(interval), stopping(false) {
+    worker = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::duration<double>(this->interval));
+            if (stopping) {
+                break; // stop() writes the final file
+            }
+            lock.unlock();
+            writeFile(this->path);
+            lock.lock();
+        }
+    });
+}
+
+/**
+ * @brief Destructor
+ */
+Exporter::~Exporter() {
+    stop();
+}
+
+/**
+ * @brief Stops the thread, then writes the file once more
+ */
+void Exporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+        writeFile(path); // After the thread is gone, so it sees every earlier update
+    }
+}
+
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Namespace containing process metrics exported in Prometheus text format
+ * @details Counters and histograms keep one cache-line sized slot per thread, so recording
+ *          is a single uncontended relaxed atomic add and never takes a lock. Reading sums
+ *          the slots. Metrics register themselves on construction and are exported together
+ *          by writeText() or periodically to a file by Exporter, e.g. for the node exporter
+ *          textfile collector.
+ */
+namespace Metrics {
+    const unsigned int slotCount = 64;  ///< Per-thread slots; more threads share slots safely
+
+    /**
+     * @brief Gets the slot of the calling thread
+     * @return Slot index in [0, slotCount)
+     */
+    unsigned int threadSlot();
+
+    /**
+     * @brief Formats one label pair for the labels argument of a metric
+     * @param name Label name (letters, digits and underscores)
+     * @param value Label value, any text
+     * @return name="value" with backslash, double quote and newline escaped
+     */
+    std::string label(const std::string& name, const std::string& value);
+
+    /**
+     * @brief Abstract base class of all metrics
+     */
+    class Metric {
+    private:
+        std::string m_name;    ///< Metric name, e.g. imageprocessing_images_total
+        std::string m_help;    ///< Description
+        std::string m_labels;  ///< Label pairs without braces, e.g. operator="blur"
+
+    public:
+        /**
+         * @brief Constructor registering the metric
+         * @param name Metric name
+         * @param help Description
+         * @param labels Label pairs without braces (may be empty), built with label()
+         */
+        Metric(const std::string& name, const std::string& help, const std::string& labels);
+
+        /**
+         * @brief Destructor unregistering the metric
+         */
+        virtual ~Metric();
+
+        /**
+         * @brief Gets the metric name
+         * @return Name
+         */
+        const std::string& name() const { return m_name; }
+
+        /**
+         * @brief Gets the description
+         * @return Description
+         */
+        const std::string& help() const { return m_help; }
+
+        /**
+         * @brief Gets the labels
+         * @return Label pairs without braces
+         */
+        const std::string& labels() const { return m_labels; }
+
+        /**
+         * @brief Gets the Prometheus type
+         * @return "counter", "gauge" or "histogram"
+         */
+        virtual const char* type() const = 0;
+
+        /**
+         * @brief Writes the sample lines of the metric
+         * @param os Output stream
+         */
+        virtual void write(std::ostream& os) const = 0;
+
+        Metric(const Metric&) = delete;
+        Metric& operator=(const Metric&) = delete;
+    };
+
+    /**
+     * @brief Monotonic counter
+     */
+    class Counter : public Metric {
+    private:
+        /**
+         * @brief Per-thread slot padded to a cache line
+         */
+        struct alignas(64) Slot {
+            std::atomic<uint64_t> value{0};  ///< Count of the threads using the slot
+        };
+        std::unique_ptr<Slot[]> slots;  ///< One slot per thread
+
+    public:
+        /**
+         * @brief Constructor
+         * @param name Metric name (should end in _total)
+         * @param help Description
+         * @param labels Label pairs without braces (default: none)
+         */
+        Counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        /**
+         * @brief Increments the counter
+         * @param amount Amount to add (default: 1)
+         */
+        void add(uint64_t amount = 1) {
+            slots[threadSlot()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Gets the current value
+         * @return Sum over all threads
+         */
+        uint64_t value() const;
+
+        const char* type() const override { return "counter"; }
+        void write(std::ostream& os) const override;
+    };
+
+    /**
+     * @brief Value that can go up and down, e.g. a queue depth
+     */
+    class Gauge : public Metric {
+    private:
+        std::atomic<int64_t> m_value;  ///< Current value
+
+    public:
+        /**
+         * @brief Constructor
+         * @param name Metric name
+         * @param help Description
+         * @param labels Label pairs without braces (default: none)
+         */
+        Gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        /**
+         * @brief Sets the value
+         * @param value New value
+         */
+        void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+
+        /**
+         * @brief Adds to the value
+         * @param amount Amount to add (may be negative)
+         */
+        void add(int64_t amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the current value
+         * @return Value
+         */
+        int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+        const char* type() const override { return "gauge"; }
+        void write(std::ostream& os) const override;
+    };
+
+    /**
+     * @brief Distribution of observed values with fixed bucket bounds
+     */
+    class Histogram : public Metric {
+    private:
+        /**
+         * @brief Cache line of eight counters
+         */
+        struct alignas(64) Line {
+            std::atomic<uint64_t> word[8];  ///< Bucket counts or the sum
+        };
+
+        std::vector<double> bounds;     ///< Upper bounds of the buckets, ascending
+        unsigned int linesPerSlot;      ///< Cache lines per slot: buckets, +Inf, sum, padding
+        std::unique_ptr<Line[]> lines;  ///< Slot after slot: counts, then sum in nanounits
+
+        /**
+         * @brief Gets a counter of a slot
+         * @param slot Slot index
+         * @param i Counter index within the slot
+         * @return Counter
+         */
+        std::atomic<uint64_t>& word(unsigned int slot, size_t i) const {
+            return lines[static_cast<size_t>(slot) * linesPerSlot + i / 8].word[i % 8];
+        }
+
+    public:
+        /**
+         * @brief Constructor
+         * @param name Metric name
+         * @param help Description
+         * @param bounds Upper bounds of the buckets, ascending
+         * @param labels Label pairs without braces (default: none)
+         */
+        Histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+                  const std::string& labels = "");
+
+        /**
+         * @brief Records a value
+         * @param value Observed value, e.g. seconds (non-negative)
+         */
+        void observe(double value);
+
+        /**
+         * @brief Gets bounds from 1 ms to about 16 s in powers of two
+         * @return Bucket bounds in seconds
+         */
+        static std::vector<double> latencyBounds();
+
+        const char* type() const override { return "histogram"; }
+        void write(std::ostream& os) const override;
+    };
+
+    /**
+     * @brief Writes all registered metrics in Prometheus text format
+     * @param os Output stream
+     */
+    void writeText(std::ostream& os);
+
+    /**
+     * @brief Writes all registered metrics to a file
+     * @param path Output file path
+     * @return true if successful, false otherwise
+     * @details Writes a temporary file next to path and renames it, so readers never see
+     *          a partially written file
+     */
+    bool writeFile(const std::string& path);
+
+    /**
+     * @brief Class writing the metrics file periodically from a background thread
+     */
+    class Exporter {
+    private:
+        std::string path;                 ///< Output file path
+        double interval;                  ///< Seconds between writes
+        std::mutex mutex;                 ///< Protects stopping
+        std::condition_variable wake;     ///< Wakes the thread for stopping
+        bool stopping;                    ///< true once stop() was called
+        std::thread worker;               ///< Background thread
+
+    public:
+        /**
+         * @brief Constructor starting the background thread
+         * @param path Output file path
+         * @param interval Seconds between writes (default: 5)
+         */
+        Exporter(const std::string& path, double interval = 5.0);
+
+        /**
+         * @brief Destructor
+         * @details Stops the thread after a final write
+         */
+        ~Exporter();
+
+        /**
+         * @brief Stops the thread, then writes the file once more
+         * @details The final write happens after the thread has exited, so it includes
+         *          every update made before stop() was called
+         */
+        void stop();
+
+        Exporter(const Exporter&) = delete;
+        Exporter& operator=(const Exporter&) = delete;
+    };
+}
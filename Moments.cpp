@@ -0,0 +1,184 @@
+#include "Moments.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace {
+
+#if defined(__SIZEOF_INT128__) && defined(__GNUC__)
+// __extension__ marks the GNU 128-bit type as intended, so -Wpedantic stays quiet
+__extension__ typedef unsigned __int128 Accumulator;  ///< Exact for any image that fits in 16-bit coordinates
+#else
+using Accumulator = long double;        ///< Fallback for compilers without 128-bit integers
+#endif
+
+const unsigned int chunkWidth = 1024;  ///< Columns summed with 64-bit counters before widening
+
+/**
+ * @brief Raw moment sums m[p][q] for p + q <= 3
+ */
+struct RawSums {
+    Accumulator m[4][4] = {};
+
+    /**
+     * @brief Adds the sums of another band
+     * @param other Partial sums to merge
+     */
+    void merge(const RawSums& other) {
+        for (int p = 0; p < 4; ++p) {
+            for (int q = 0; q + p < 4; ++q) {
+                m[p][q] += other.m[p][q];
+            }
+        }
+    }
+};
+
+/**
+ * @brief Sums rows [begin, end) of the region
+ * @param img Source image
+ * @param x0 Left edge of the region
+ * @param y0 Top edge of the region
+ * @param width Width of the region
+ * @param begin First row (relative to the region)
+ * @param end One past the last row (relative to the region)
+ * @param binary true to treat non-zero pixels as 1
+ * @return Partial sums of the band
+ * @details Every row is cut into chunks; inside a chunk the column offset t is small, so
+ *          sum(t^k v) fits in 64 bits and the loop is four independent dot products.
+ *          The chunk sums are shifted to the chunk position c with the binomial expansion
+ *          of (c + t)^k and then weighted by y^q, all in exact wide integers
+ */
+RawSums sumBand(const Image& img, unsigned int x0, unsigned int y0, unsigned int width,
+                unsigned int begin, unsigned int end, bool binary) {
+    RawSums sums;
+    unsigned long long powers[3][chunkWidth];
+    for (unsigned int t = 0; t < chunkWidth; ++t) {
+        powers[0][t] = t;
+        powers[1][t] = static_cast<unsigned long long>(t) * t;
+        powers[2][t] = static_cast<unsigned long long>(t) * t * t;
+    }
+
+    for (unsigned int y = begin; y < end; ++y) {
+        const unsigned char* in = img.row(y0 + y) + x0;
+        Accumulator row[4] = {}; // sum over the row of x^p * v
+
+        for (unsigned int c = 0; c < width; c += chunkWidth) {
+            unsigned int n = std::min(chunkWidth, width - c);
+            unsigned long long s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for (unsigned int t = 0; t < n; ++t) {
+                unsigned long long v = binary ? (in[c + t] != 0) : in[c + t];
+                s0 += v;
+                s1 += powers[0][t] * v;
+                s2 += powers[1][t] * v;
+                s3 += powers[2][t] * v;
+            }
+
+            Accumulator C = c;
+            row[0] += s0;
+            row[1] += C * s0 + s1;
+            row[2] += C * C * s0 + 2 * C * s1 + s2;
+            row[3] += C * C * C * s0 + 3 * C * C * s1 + 3 * C * s2 + s3;
+        }
+
+        Accumulator Y = y;
+        Accumulator yPow[4] = {1, Y, Y * Y, Y * Y * Y};
+        for (int p = 0; p < 4; ++p) {
+            for (int q = 0; q + p < 4; ++q) {
+                sums.m[p][q] += yPow[q] * row[p];
+            }
+        }
+    }
+    return sums;
+}
+
+}
+
+namespace ImageMoments {
+
+/**
+ * @brief Computes the moments of a whole image
+ * @param img Grayscale image
+ * @param binary true to treat every non-zero pixel as 1
+ * @return Moments
+ */
+Moments compute(const Image& img, bool binary) {
+    return compute(img, Rectangle(0, 0, img.width(), img.height()), binary);
+}
+
+/**
+ * @brief Computes the moments of a region of an image
+ * @param img Grayscale image
+ * @param roi Region to measure
+ * @param binary true to treat every non-zero pixel as 1
+ * @return Moments relative to the region
+ * @details Raw moments are accumulated exactly in one pass over the pixels, row bands in
+ *          parallel, and merged at the end. Derived moments are computed from them in
+ *          long double
+ */
+Moments compute(const Image& img, Rectangle roi, bool binary) {
+    Moments result;
+    roi = roi & Rectangle(0, 0, img.width(), img.height());
+    unsigned int width = roi.getWidth();
+    unsigned int height = roi.getHeight();
+    if (width == 0 || height == 0) {
+        return result;
+    }
+
+    RawSums total;
+    std::mutex totalMutex;
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        RawSums band = sumBand(img, roi.getX(), roi.getY(), width, begin, end, binary);
+        std::lock_guard<std::mutex> lock(totalMutex);
+        total.merge(band);
+    });
+
+    auto m = [&](int p, int q) { return static_cast<long double>(total.m[p][q]); };
+    result.m00 = static_cast<double>(m(0, 0));
+    result.m10 = static_cast<double>(m(1, 0));
+    result.m01 = static_cast<double>(m(0, 1));
+    result.m20 = static_cast<double>(m(2, 0));
+    result.m11 = static_cast<double>(m(1, 1));
+    result.m02 = static_cast<double>(m(0, 2));
+    result.m30 = static_cast<double>(m(3, 0));
+    result.m21 = static_cast<double>(m(2, 1));
+    result.m12 = static_cast<double>(m(1, 2));
+    result.m03 = static_cast<double>(m(0, 3));
+    if (m(0, 0) == 0) {
+        return result; // Empty region, no centroid
+    }
+
+    long double xc = m(1, 0) / m(0, 0);
+    long double yc = m(0, 1) / m(0, 0);
+    result.mu20 = static_cast<double>(m(2, 0) - xc * m(1, 0));
+    result.mu11 = static_cast<double>(m(1, 1) - xc * m(0, 1));
+    result.mu02 = static_cast<double>(m(0, 2) - yc * m(0, 1));
+    result.mu30 = static_cast<double>(m(3, 0) - 3 * xc * m(2, 0) + 2 * xc * xc * m(1, 0));
+    result.mu21 = static_cast<double>(m(2, 1) - 2 * xc * m(1, 1) - yc * m(2, 0) + 2 * xc * xc * m(0, 1));
+    result.mu12 = static_cast<double>(m(1, 2) - 2 * yc * m(1, 1) - xc * m(0, 2) + 2 * yc * yc * m(1, 0));
+    result.mu03 = static_cast<double>(m(0, 3) - 3 * yc * m(0, 2) + 2 * yc * yc * m(0, 1));
+
+    double s2 = result.m00 * result.m00;            // m00^(1 + 2/2)
+    double s3 = s2 * std::sqrt(result.m00);         // m00^(1 + 3/2)
+    result.nu20 = result.mu20 / s2;
+    result.nu11 = result.mu11 / s2;
+    result.nu02 = result.mu02 / s2;
+    result.nu30 = result.mu30 / s3;
+    result.nu21 = result.mu21 / s3;
+    result.nu12 = result.mu12 / s3;
+    result.nu03 = result.mu03 / s3;
+
+    double n20 = result.nu20, n11 = result.nu11, n02 = result.nu02;
+    double n30 = result.nu30, n21 = result.nu21, n12 = result.nu12, n03 = result.nu03;
+    double a = n30 + n12, b = n21 + n03;
+    result.hu[0] = n20 + n02;
+    result.hu[1] = (n20 - n02) * (n20 - n02) + 4 * n11 * n11;
+    result.hu[2] = (n30 - 3 * n12) * (n30 - 3 * n12) + (3 * n21 - n03) * (3 * n21 - n03);
+    result.hu[3] = a * a + b * b;
+    result.hu[4] = (n30 - 3 * n12) * a * (a * a - 3 * b * b) + (3 * n21 - n03) * b * (3 * a * a - b * b);
+    result.hu[5] = (n20 - n02) * (a * a - b * b) + 4 * n11 * a * b;
+    result.hu[6] = (3 * n21 - n03) * a * (a * a - 3 * b * b) - (n30 - 3 * n12) * b * (3 * a * a - b * b);
+    return result;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Image.h"
+#include "Rectangle.h"
+
+/**
+ * @brief Structure holding image moments up to third order
+ * @details Spatial moments are relative to the top-left corner of the measured region.
+ *          Central moments are taken about the centroid, normalized central moments are
+ *          scale invariant and Hu moments are also rotation invariant
+ */
+struct Moments {
+    double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0; ///< Spatial moments
+    double mu20 = 0, mu11 = 0, mu02 = 0, mu30 = 0, mu21 = 0, mu12 = 0, mu03 = 0; ///< Central moments
+    double nu20 = 0, nu11 = 0, nu02 = 0, nu30 = 0, nu21 = 0, nu12 = 0, nu03 = 0; ///< Normalized central moments
+    double hu[7] = {0, 0, 0, 0, 0, 0, 0};                                        ///< Hu invariants
+};
+
+/**
+ * @brief Namespace containing moment computation
+ */
+namespace ImageMoments {
+    /**
+     * @brief Computes the moments of a whole image
+     * @param img Grayscale image, pixel values are used as weights
+     * @param binary true to treat every non-zero pixel as 1 (default: false)
+     * @return Spatial, central, normalized and Hu moments
+     */
+    Moments compute(const Image& img, bool binary = false);
+
+    /**
+     * @brief Computes the moments of a region of an image
+     * @param img Grayscale image, pixel values are used as weights
+     * @param roi Region to measure (clipped to the image)
+     * @param binary true to treat every non-zero pixel as 1 (default: false)
+     * @return Moments with coordinates relative to the top-left corner of the region
+     */
+    Moments compute(const Image& img, Rectangle roi, bool binary = false);
+}
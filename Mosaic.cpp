@@ -0,0 +1,259 @@
+#include "Mosaic.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+/**
+ * @brief Reads a block of rows of a file tile
+ * @param path Path of the tile file
+ * @param offset File offset of the first row
+ * @param data Receives the rows
+ * @param size Number of bytes to read
+ * @return true if all bytes were read
+ */
+bool readRows(const std::string& path, size_t offset, unsigned char* data, size_t size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    off_t position = static_cast<off_t>(offset);
+    while (size > 0) {
+        ssize_t n = pread(fd, data, size, position);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        position += n;
+    }
+    close(fd);
+    return size == 0;
+}
+}
+
+/**
+ * @brief Constructor
+ * @param width Canvas width
+ * @param height Canvas height
+ * @param feather Feather width in pixels, 0 to let later tiles overwrite earlier ones
+ * @param background Value of pixels no tile covers
+ */
+Mosaic::Mosaic(unsigned int width, unsigned int height, unsigned int feather, unsigned char background)
+    : canvasWidth(width), canvasHeight(height), feather(feather), background(background),
+      buckets((height + bucketHeight - 1) / bucketHeight) {}
+
+/**
+ * @brief Adds a placement to the spatial index
+ * @param placement Placed tile
+ * @return true if the tile intersects the canvas
+ * @details The placement is listed in every bucket of bucketHeight canvas rows it
+ *          covers, so a band only looks at the placements of its own buckets
+ */
+bool Mosaic::insert(const Placement& placement) {
+    Rectangle visible = placement.bounds & Rectangle(0, 0, canvasWidth, canvasHeight);
+    if (visible.getWidth() == 0 || visible.getHeight() == 0) {
+        return false;
+    }
+
+    unsigned int index = static_cast<unsigned int>(placements.size());
+    unsigned int first = static_cast<unsigned int>(visible.getY()) / bucketHeight;
+    unsigned int last = (static_cast<unsigned int>(visible.getY()) + visible.getHeight() - 1) / bucketHeight;
+    for (unsigned int b = first; b <= last; ++b) {
+        buckets[b].push_back(index);
+    }
+    placements.push_back(placement);
+    return true;
+}
+
+/**
+ * @brief Places an in-memory tile
+ * @param tile Tile image
+ * @param offset Canvas position of the top-left tile pixel
+ * @return true if the tile intersects the canvas, false if it was ignored
+ */
+bool Mosaic::add(const Image& tile, const Point& offset) {
+    Placement placement{Rectangle(offset.getX(), offset.getY(), tile.width(), tile.height()), &tile, std::string(), 0};
+    return !tile.isEmpty() && insert(placement);
+}
+
+/**
+ * @brief Places a tile stored in a P5 PGM file
+ * @param tilePath Path of the tile file
+ * @param offset Canvas position of the top-left tile pixel
+ * @return true if the tile intersects the canvas, false if it was ignored or has no valid header
+ */
+bool Mosaic::add(const std::string& tilePath, const Point& offset) {
+    PGMInfo info;
+    if (!Image::probe(tilePath, info) || info.format != "P5" || info.maxValue == 0 || info.maxValue > 255 ||
+        info.width == 0 || info.height == 0) {
+        return false;
+    }
+    Placement placement{Rectangle(offset.getX(), offset.getY(), info.width, info.height), nullptr, tilePath,
+                        info.dataOffset};
+    return insert(placement);
+}
+
+/**
+ * @brief Finds the placements intersecting a range of canvas rows
+ * @param y0 First row
+ * @param y1 One past the last row
+ * @return Placement indices in placement order
+ */
+std::vector<unsigned int> Mosaic::query(unsigned int y0, unsigned int y1) const {
+    std::vector<unsigned int> result;
+    y1 = std::min(y1, canvasHeight);
+    if (y0 >= y1) {
+        return result;
+    }
+
+    for (unsigned int b = y0 / bucketHeight; b <= (y1 - 1) / bucketHeight; ++b) {
+        for (unsigned int index : buckets[b]) {
+            const Rectangle& r = placements[index].bounds;
+            if (r.getY() < static_cast<int>(y1) && r.getY() + static_cast<int>(r.getHeight()) > static_cast<int>(y0)) {
+                result.push_back(index);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end()); // Tiles spanning several buckets are listed once per bucket
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+/**
+ * @brief Renders a band of canvas rows
+ * @param y0 First row
+ * @param y1 One past the last row
+ * @param rows Receives (y1 - y0) rows of width() pixels
+ * @return true if successful, false if a file tile could not be read
+ * @details Placements are drawn in placement order. File tiles read the rows inside the
+ *          band with one positional read. Feathered bands accumulate weighted sums in
+ *          integers, so the result does not depend on how the canvas is split into bands
+ */
+bool Mosaic::render(unsigned int y0, unsigned int y1, unsigned char* rows) const {
+    size_t count = static_cast<size_t>(y1 - y0) * canvasWidth;
+    std::fill(rows, rows + count, background);
+
+    std::vector<unsigned long long> sum;
+    std::vector<unsigned int> weight;
+    if (feather > 0) {
+        sum.assign(count, 0);
+        weight.assign(count, 0);
+    }
+
+    bool ok = true;
+    std::vector<unsigned char> fileRows;
+    std::vector<unsigned int> columnWeight;
+    Rectangle band(0, static_cast<int>(y0), canvasWidth, y1 - y0);
+
+    for (unsigned int index : query(y0, y1)) {
+        const Placement& p = placements[index];
+        Rectangle area = p.bounds & band;
+        if (area.getWidth() == 0 || area.getHeight() == 0) {
+            continue;
+        }
+
+        unsigned int tileWidth = p.bounds.getWidth();
+        unsigned int tileHeight = p.bounds.getHeight();
+        unsigned int tx0 = static_cast<unsigned int>(area.getX() - p.bounds.getX());
+        unsigned int ty0 = static_cast<unsigned int>(area.getY() - p.bounds.getY());
+        unsigned int cx0 = static_cast<unsigned int>(area.getX());
+
+        if (!p.image) {
+            fileRows.resize(static_cast<size_t>(area.getHeight()) * tileWidth);
+            if (!readRows(p.path, p.dataOffset + static_cast<size_t>(ty0) * tileWidth, fileRows.data(), fileRows.size())) {
+                ok = false;
+                continue;
+            }
+        }
+
+        if (feather > 0) {
+            columnWeight.resize(area.getWidth());
+            for (unsigned int i = 0; i < area.getWidth(); ++i) {
+                unsigned int tx = tx0 + i;
+                columnWeight[i] = std::min(std::min(tx, tileWidth - 1 - tx) + 1, feather);
+            }
+        }
+
+        for (unsigned int j = 0; j < area.getHeight(); ++j) {
+            unsigned int ty = ty0 + j;
+            const unsigned char* src = p.image ? p.image->row(static_cast<int>(ty)) : &fileRows[static_cast<size_t>(j) * tileWidth];
+            src += tx0;
+            size_t out = static_cast<size_t>(area.getY() - static_cast<int>(y0) + static_cast<int>(j)) * canvasWidth + cx0;
+
+            if (feather == 0) {
+                std::copy(src, src + area.getWidth(), rows + out);
+                continue;
+            }
+
+            unsigned int rowWeight = std::min(std::min(ty, tileHeight - 1 - ty) + 1, feather);
+            for (unsigned int i = 0; i < area.getWidth(); ++i) {
+                unsigned int w = columnWeight[i] * rowWeight;
+                sum[out + i] += static_cast<unsigned long long>(w) * src[i];
+                weight[out + i] += w;
+            }
+        }
+    }
+
+    if (feather > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            if (weight[i] > 0) {
+                rows[i] = static_cast<unsigned char>((sum[i] + weight[i] / 2) / weight[i]);
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Renders the whole canvas into an image
+ * @param dst Destination image
+ * @return true if successful, false if a file tile could not be read
+ */
+bool Mosaic::compose(Image& dst) const {
+    dst = Image(canvasWidth, canvasHeight);
+    if (canvasWidth == 0 || canvasHeight == 0) {
+        return true;
+    }
+    unsigned int bands = (canvasHeight + bucketHeight - 1) / bucketHeight;
+    std::atomic<bool> ok(true);
+
+    Parallel::forRange(bands, [&](unsigned int begin, unsigned int end) {
+        std::vector<unsigned char> rows;
+        for (unsigned int b = begin; b < end; ++b) {
+            unsigned int y0 = b * bucketHeight;
+            unsigned int y1 = std::min(canvasHeight, y0 + bucketHeight);
+            rows.resize(static_cast<size_t>(y1 - y0) * canvasWidth);
+            if (!render(y0, y1, rows.data())) {
+                ok = false;
+            }
+            for (unsigned int y = y0; y < y1; ++y) {
+                std::copy(&rows[static_cast<size_t>(y - y0) * canvasWidth],
+                          &rows[static_cast<size_t>(y - y0) * canvasWidth] + canvasWidth, dst.row(static_cast<int>(y)));
+            }
+        }
+    }, 1);
+    return ok;
+}
+
+/**
+ * @brief Streams the canvas into a P5 PGM file
+ * @param path Output path
+ * @param direct true to write with O_DIRECT
+ * @return true if successful, false otherwise
+ */
+bool Mosaic::save(const std::string& path, bool direct) const {
+    std::atomic<bool> ok(true);
+    bool written = Image::saveBands(path, canvasWidth, canvasHeight, [&](unsigned int y0, unsigned int y1, unsigned char* rows) {
+        if (!render(y0, y1, rows)) {
+            ok = false;
+        }
+    }, direct);
+    return written && ok;
+}
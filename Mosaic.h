@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Image.h"
+#include "Point.h"
+#include "Rectangle.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class composing many tiles into one large canvas
+ * @details Tiles are placed at integer offsets and may overlap or extend past the canvas.
+ *          Without feathering the last placement covering a pixel wins. With a feather
+ *          width F every tile pixel gets the weight min(dx + 1, F) * min(dy + 1, F), where
+ *          dx and dy are its distances to the nearest vertical and horizontal tile edge,
+ *          and overlaps are blended by weighted average, so seams fade over F pixels.
+ *
+ *          The canvas is never held in memory. It is rendered band by band, straight into
+ *          the output file, and each band only touches the placements a band-bucket index
+ *          reports as intersecting it. Tiles can be images owned by the caller or PGM
+ *          files, of which only the rows inside the current band are read.
+ */
+class Mosaic {
+public:
+    static constexpr unsigned int bucketHeight = 256;  ///< Canvas rows per spatial index bucket
+
+private:
+    /**
+     * @brief Structure describing one placed tile
+     */
+    struct Placement {
+        Rectangle bounds;           ///< Area covered on the canvas, before clipping
+        const Image* image;         ///< In-memory tile, or nullptr for file tiles
+        std::string path;           ///< Path of a file tile
+        size_t dataOffset;          ///< Raster offset of a file tile
+    };
+
+    unsigned int canvasWidth;                       ///< Canvas width
+    unsigned int canvasHeight;                      ///< Canvas height
+    unsigned int feather;                           ///< Feather width in pixels, 0 for none
+    unsigned char background;                       ///< Value of pixels no tile covers
+    std::vector<Placement> placements;              ///< Tiles in placement order
+    std::vector<std::vector<unsigned int>> buckets; ///< Placements intersecting each band of bucketHeight rows
+
+    /**
+     * @brief Adds a placement to the spatial index
+     * @param placement Placed tile
+     * @return true if the tile intersects the canvas
+     */
+    bool insert(const Placement& placement);
+
+public:
+    /**
+     * @brief Constructor
+     * @param width Canvas width
+     * @param height Canvas height
+     * @param feather Feather width in pixels, 0 to let later tiles overwrite earlier ones (default: 0)
+     * @param background Value of pixels no tile covers (default: 0)
+     */
+    Mosaic(unsigned int width, unsigned int height, unsigned int feather = 0, unsigned char background = 0);
+
+    /**
+     * @brief Places an in-memory tile
+     * @param tile Tile image; must stay alive and unchanged until rendering is done
+     * @param offset Canvas position of the top-left tile pixel
+     * @return true if the tile intersects the canvas, false if it was ignored
+     */
+    bool add(const Image& tile, const Point& offset);
+
+    /**
+     * @brief Places a tile stored in a P5 PGM file
+     * @param tilePath Path of the tile file
+     * @param offset Canvas position of the top-left tile pixel
+     * @return true if the tile intersects the canvas, false if it was ignored or has no valid header
+     * @details Only the header is read here; rows are read when the bands they cover are rendered
+     */
+    bool add(const std::string& tilePath, const Point& offset);
+
+    /**
+     * @brief Finds the placements intersecting a range of canvas rows
+     * @param y0 First row
+     * @param y1 One past the last row
+     * @return Placement indices in placement order
+     */
+    std::vector<unsigned int> query(unsigned int y0, unsigned int y1) const;
+
+    /**
+     * @brief Renders a band of canvas rows
+     * @param y0 First row
+     * @param y1 One past the last row
+     * @param rows Receives (y1 - y0) rows of width() pixels
+     * @return true if successful, false if a file tile could not be read
+     */
+    bool render(unsigned int y0, unsigned int y1, unsigned char* rows) const;
+
+    /**
+     * @brief Renders the whole canvas into an image
+     * @param dst Destination image
+     * @return true if successful, false if a file tile could not be read
+     * @details Intended for canvases that fit in memory; use save() otherwise
+     */
+    bool compose(Image& dst) const;
+
+    /**
+     * @brief Streams the canvas into a P5 PGM file
+     * @param path Output path
+     * @param direct true to write with O_DIRECT (see Image::saveBands)
+     * @return true if successful, false otherwise
+     * @details Bands are rendered in parallel, each holding only its own rows
+     */
+    bool save(const std::string& path, bool direct = false) const;
+
+    /**
+     * @brief Gets the canvas width
+     * @return Width in pixels
+     */
+    unsigned int width() const { return canvasWidth; }
+
+    /**
+     * @brief Gets the canvas height
+     * @return Height in pixels
+     */
+    unsigned int height() const { return canvasHeight; }
+
+    /**
+     * @brief Gets the number of placed tiles
+     * @return Number of tiles intersecting the canvas
+     */
+    size_t size() const { return placements.size(); }
+};
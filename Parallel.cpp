@@ -0,0 +1,64 @@
+#include "Parallel.h"
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace Parallel {
+
+/**
+ * @brief Gets the number of worker threads to use
+ * @return Number of hardware threads, at least 1
+ */
+unsigned int threadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Runs a function on a fixed number of workers
+ * @param workers Number of workers to start
+ * @param body Function called once per worker with the worker index
+ * @details Worker 0 runs on the calling thread, the others on new threads which are joined before returning
+ */
+void run(unsigned int workers, const std::function<void(unsigned int)>& body) {
+    if (workers == 0) {
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned int i = 1; i < workers; ++i) {
+        threads.emplace_back(body, i);
+    }
+    body(0); // Calling thread does its share instead of just waiting
+
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Splits [0, count) into contiguous ranges and processes them in parallel
+ * @param count Number of items to process
+ * @param body Function called with the [begin, end) range of each chunk
+ * @param minChunk Minimum number of items per chunk
+ * @details Uses at most threadCount() chunks of nearly equal size
+ */
+void forRange(unsigned int count, const std::function<void(unsigned int, unsigned int)>& body, unsigned int minChunk) {
+    if (count == 0) {
+        return;
+    }
+
+    unsigned int chunks = std::min(threadCount(), std::max(1u, count / std::max(1u, minChunk)));
+    if (chunks == 1) {
+        body(0, count); // Not worth starting threads
+        return;
+    }
+
+    run(chunks, [&](unsigned int i) {
+        unsigned int begin = static_cast<unsigned int>(static_cast<unsigned long long>(count) * i / chunks);
+        unsigned int end = static_cast<unsigned int>(static_cast<unsigned long long>(count) * (i + 1) / chunks);
+        body(begin, end);
+    });
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+
+/**
+ * @brief Namespace containing helpers for running image work on several threads
+ * @details Work is split into contiguous ranges (usually row bands) so each thread
+ *          touches its own part of the image
+ */
+namespace Parallel {
+    /**
+     * @brief Gets the number of worker threads to use
+     * @return Number of hardware threads, at least 1
+     */
+    unsigned int threadCount();
+
+    /**
+     * @brief Runs a function on a fixed number of workers
+     * @param workers Number of workers to start
+     * @param body Function called once per worker with the worker index
+     * @details Worker 0 runs on the calling thread. Returns when all workers finished
+     */
+    void run(unsigned int workers, const std::function<void(unsigned int)>& body);
+
+    /**
+     * @brief Splits [0, count) into contiguous ranges and processes them in parallel
+     * @param count Number of items (e.g. rows) to process
+     * @param body Function called with the [begin, end) range of each chunk
+     * @param minChunk Minimum number of items per chunk, so small jobs stay on one thread
+     */
+    void forRange(unsigned int count, const std::function<void(unsigned int, unsigned int)>& body,
+                  unsigned int minChunk = 16);
+}
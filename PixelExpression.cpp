@@ -0,0 +1,454 @@
+#include "PixelExpression.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+/**
+ * @brief Saturates a value to a gray value
+ * @param v Value to convert
+ * @return v clamped to [0,255] and truncated (NaN becomes 0)
+ */
+inline unsigned char saturate(float v) {
+    return static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, v)));
+}
+
+}
+
+/**
+ * @brief Default constructor
+ * @details Compiles the identity expression "a"
+ */
+PixelExpression::PixelExpression() : registerCount(0), resultRegister(0), variableCount(0), folded(false), pos(0) {
+    compile("a");
+}
+
+/**
+ * @brief Constructor compiling an expression
+ * @param expression Source text of the expression
+ */
+PixelExpression::PixelExpression(const std::string& expression)
+    : registerCount(0), resultRegister(0), variableCount(0), folded(false), pos(0) {
+    compile(expression);
+}
+
+/**
+ * @brief Compiles an expression
+ * @param expression Source text of the expression
+ * @return true if compilation was successful, false otherwise
+ * @details Parses with recursive descent and emits one instruction per operation into a
+ *          fresh register. Operations on constants are evaluated at compile time.
+ *          If at most one variable is used, the program is run once over all 256 gray
+ *          values and replaced by a lookup table.
+ */
+bool PixelExpression::compile(const std::string& expression) {
+    program.clear();
+    constants.clear();
+    registerCount = 0;
+    resultRegister = 0;
+    variableCount = 0;
+    folded = false;
+    errorMessage.clear();
+    sourceText = expression;
+    pos = 0;
+
+    Value result;
+    if (!parseExpression(result)) {
+        program.clear();
+        constants.clear();
+        registerCount = 0;
+        return false;
+    }
+    skipSpaces();
+    if (pos != sourceText.size()) {
+        program.clear();
+        constants.clear();
+        registerCount = 0;
+        return fail("unexpected character");
+    }
+
+    if (result.isConstant) {
+        result = makeConstant(result.constant); // Result needs a register even if it is known
+    }
+    resultRegister = result.reg;
+
+    if (variableCount <= 1) { // Fold into a table: run the program once for a = 0..255
+        unsigned char gray[blockSize];
+        for (unsigned int v = 0; v < 256; ++v) {
+            gray[v] = static_cast<unsigned char>(v);
+        }
+        const unsigned char* inputs[maxVariables] = {gray};
+        std::vector<float> registers(static_cast<size_t>(registerCount) * blockSize);
+        for (const auto& c : constants) {
+            std::fill_n(&registers[static_cast<size_t>(c.first) * blockSize], blockSize, c.second);
+        }
+        runBlock(inputs, 256, registers.data(), lut.data());
+        folded = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Records a compile error
+ * @param message Description of the error
+ * @return Always false
+ */
+bool PixelExpression::fail(const std::string& message) {
+    errorMessage = message + " at position " + std::to_string(pos);
+    return false;
+}
+
+/**
+ * @brief Skips whitespace in the source text
+ */
+void PixelExpression::skipSpaces() {
+    while (pos < sourceText.size() && std::isspace(static_cast<unsigned char>(sourceText[pos]))) {
+        ++pos;
+    }
+}
+
+/**
+ * @brief Allocates a register holding a constant
+ * @param value Constant value
+ * @return Value referring to the register (reused if the constant already has one)
+ */
+PixelExpression::Value PixelExpression::makeConstant(float value) {
+    for (const auto& c : constants) {
+        if (c.second == value) {
+            return Value{c.first, false, 0};
+        }
+    }
+    unsigned int reg = registerCount++;
+    constants.push_back({reg, value});
+    return Value{reg, false, 0};
+}
+
+/**
+ * @brief Emits an operation, folding it if all operands are constants
+ * @param op Operation
+ * @param a First operand
+ * @param b Second operand
+ * @param c Third operand
+ * @param operands Number of operands used (1 to 3)
+ * @return Value holding the result
+ */
+PixelExpression::Value PixelExpression::emit(OpCode op, const Value& a, const Value& b, const Value& c, unsigned int operands) {
+    const Value* args[3] = {&a, &b, &c};
+
+    bool allConstant = true;
+    for (unsigned int i = 0; i < operands; ++i) {
+        allConstant = allConstant && args[i]->isConstant;
+    }
+
+    if (allConstant) { // Same arithmetic as runBlock, done once at compile time
+        float x = a.constant, y = b.constant, z = c.constant, r = 0;
+        switch (op) {
+            case OpCode::Add: r = x + y; break;
+            case OpCode::Sub: r = x - y; break;
+            case OpCode::Mul: r = x * y; break;
+            case OpCode::Div: r = x / y; break;
+            case OpCode::Neg: r = -x; break;
+            case OpCode::Min: r = std::min(x, y); break;
+            case OpCode::Max: r = std::max(x, y); break;
+            case OpCode::Abs: r = std::fabs(x); break;
+            case OpCode::Sqrt: r = std::sqrt(x); break;
+            case OpCode::Clamp: r = std::min(z, std::max(y, x)); break;
+            case OpCode::Load: break;
+        }
+        return Value{0, true, r};
+    }
+
+    unsigned int regs[3] = {0, 0, 0};
+    for (unsigned int i = 0; i < operands; ++i) {
+        regs[i] = args[i]->isConstant ? makeConstant(args[i]->constant).reg : args[i]->reg;
+    }
+
+    unsigned int dst = registerCount++;
+    program.push_back(Instruction{op, dst, regs[0], regs[1], regs[2]});
+    return Value{dst, false, 0};
+}
+
+/**
+ * @brief Parses a sum or difference
+ * @param out Parsed value
+ * @return true if successful
+ */
+bool PixelExpression::parseExpression(Value& out) {
+    if (!parseTerm(out)) {
+        return false;
+    }
+    while (true) {
+        skipSpaces();
+        if (pos >= sourceText.size() || (sourceText[pos] != '+' && sourceText[pos] != '-')) {
+            return true;
+        }
+        OpCode op = sourceText[pos++] == '+' ? OpCode::Add : OpCode::Sub;
+        Value rhs;
+        if (!parseTerm(rhs)) {
+            return false;
+        }
+        out = emit(op, out, rhs, Value{0, true, 0}, 2);
+    }
+}
+
+/**
+ * @brief Parses a product or quotient
+ * @param out Parsed value
+ * @return true if successful
+ */
+bool PixelExpression::parseTerm(Value& out) {
+    if (!parseUnary(out)) {
+        return false;
+    }
+    while (true) {
+        skipSpaces();
+        if (pos >= sourceText.size() || (sourceText[pos] != '*' && sourceText[pos] != '/')) {
+            return true;
+        }
+        OpCode op = sourceText[pos++] == '*' ? OpCode::Mul : OpCode::Div;
+        Value rhs;
+        if (!parseUnary(rhs)) {
+            return false;
+        }
+        out = emit(op, out, rhs, Value{0, true, 0}, 2);
+    }
+}
+
+/**
+ * @brief Parses an optionally negated primary expression
+ * @param out Parsed value
+ * @return true if successful
+ */
+bool PixelExpression::parseUnary(Value& out) {
+    skipSpaces();
+    if (pos < sourceText.size() && sourceText[pos] == '-') {
+        ++pos;
+        Value operand;
+        if (!parseUnary(operand)) {
+            return false;
+        }
+        out = emit(OpCode::Neg, operand, Value{0, true, 0}, Value{0, true, 0}, 1);
+        return true;
+    }
+    return parsePrimary(out);
+}
+
+/**
+ * @brief Parses a number, variable, function call or parenthesized expression
+ * @param out Parsed value
+ * @return true if successful
+ */
+bool PixelExpression::parsePrimary(Value& out) {
+    skipSpaces();
+    if (pos >= sourceText.size()) {
+        return fail("unexpected end of expression");
+    }
+
+    char ch = sourceText[pos];
+    if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.') {
+        const char* begin = sourceText.c_str() + pos;
+        char* end = nullptr;
+        float value = std::strtof(begin, &end);
+        if (end == begin) {
+            return fail("invalid number");
+        }
+        pos += end - begin;
+        out = Value{0, true, value};
+        return true;
+    }
+
+    if (ch == '(') {
+        ++pos;
+        if (!parseExpression(out)) {
+            return false;
+        }
+        skipSpaces();
+        if (pos >= sourceText.size() || sourceText[pos] != ')') {
+            return fail("expected ')'");
+        }
+        ++pos;
+        return true;
+    }
+
+    if (!std::isalpha(static_cast<unsigned char>(ch))) {
+        return fail("unexpected character");
+    }
+
+    size_t start = pos;
+    while (pos < sourceText.size() && std::isalpha(static_cast<unsigned char>(sourceText[pos]))) {
+        ++pos;
+    }
+    std::string name = sourceText.substr(start, pos - start);
+
+    if (name.size() == 1 && name[0] >= 'a' && name[0] < static_cast<char>('a' + maxVariables)) { // Variable
+        unsigned int index = name[0] - 'a';
+        variableCount = std::max(variableCount, index + 1);
+        unsigned int dst = registerCount++;
+        program.push_back(Instruction{OpCode::Load, dst, index, 0, 0});
+        out = Value{dst, false, 0};
+        return true;
+    }
+
+    OpCode op;
+    unsigned int minArgs = 1, maxArgs = 1;
+    if (name == "min") { op = OpCode::Min; minArgs = maxArgs = 2; }
+    else if (name == "max") { op = OpCode::Max; minArgs = maxArgs = 2; }
+    else if (name == "abs") { op = OpCode::Abs; }
+    else if (name == "sqrt") { op = OpCode::Sqrt; }
+    else if (name == "clamp") { op = OpCode::Clamp; maxArgs = 3; }
+    else {
+        pos = start;
+        return fail("unknown name '" + name + "'");
+    }
+
+    skipSpaces();
+    if (pos >= sourceText.size() || sourceText[pos] != '(') {
+        return fail("expected '(' after " + name);
+    }
+    ++pos;
+
+    std::vector<Value> args;
+    while (true) {
+        Value arg;
+        if (!parseExpression(arg)) {
+            return false;
+        }
+        args.push_back(arg);
+        skipSpaces();
+        if (pos < sourceText.size() && sourceText[pos] == ',') {
+            ++pos;
+            continue;
+        }
+        if (pos < sourceText.size() && sourceText[pos] == ')') {
+            ++pos;
+            break;
+        }
+        return fail("expected ',' or ')'");
+    }
+
+    if (args.size() < minArgs || args.size() > maxArgs || (op == OpCode::Clamp && args.size() == 2)) {
+        return fail("wrong number of arguments for " + name);
+    }
+    if (op == OpCode::Clamp && args.size() == 1) { // clamp(x) saturates to the gray range
+        args.push_back(Value{0, true, 0.0f});
+        args.push_back(Value{0, true, 255.0f});
+    }
+
+    unsigned int operands = static_cast<unsigned int>(args.size());
+    while (args.size() < 3) {
+        args.push_back(Value{0, true, 0.0f});
+    }
+    out = emit(op, args[0], args[1], args[2], operands);
+    return true;
+}
+
+/**
+ * @brief Runs the program on one block of pixels
+ * @param inputs Pointers to the block of each input variable
+ * @param count Number of pixels in the block
+ * @param registers Register file of registerCount * blockSize floats
+ * @param out Output pixels
+ * @details The switch is executed once per instruction and block, the inner loops are
+ *          simple element-wise loops the compiler turns into vector code
+ */
+void PixelExpression::runBlock(const unsigned char* const* inputs, unsigned int count, float* registers, unsigned char* out) const {
+    for (const Instruction& in : program) {
+        float* d = registers + static_cast<size_t>(in.dst) * blockSize;
+        const float* x = registers + static_cast<size_t>(in.a) * blockSize;
+        const float* y = registers + static_cast<size_t>(in.b) * blockSize;
+        const float* z = registers + static_cast<size_t>(in.c) * blockSize;
+
+        switch (in.op) {
+            case OpCode::Load: {
+                const unsigned char* src = inputs[in.a];
+                for (unsigned int i = 0; i < count; ++i) d[i] = src[i];
+                break;
+            }
+            case OpCode::Add:   for (unsigned int i = 0; i < count; ++i) d[i] = x[i] + y[i]; break;
+            case OpCode::Sub:   for (unsigned int i = 0; i < count; ++i) d[i] = x[i] - y[i]; break;
+            case OpCode::Mul:   for (unsigned int i = 0; i < count; ++i) d[i] = x[i] * y[i]; break;
+            case OpCode::Div:   for (unsigned int i = 0; i < count; ++i) d[i] = x[i] / y[i]; break;
+            case OpCode::Neg:   for (unsigned int i = 0; i < count; ++i) d[i] = -x[i]; break;
+            case OpCode::Min:   for (unsigned int i = 0; i < count; ++i) d[i] = std::min(x[i], y[i]); break;
+            case OpCode::Max:   for (unsigned int i = 0; i < count; ++i) d[i] = std::max(x[i], y[i]); break;
+            case OpCode::Abs:   for (unsigned int i = 0; i < count; ++i) d[i] = std::fabs(x[i]); break;
+            case OpCode::Sqrt:  for (unsigned int i = 0; i < count; ++i) d[i] = std::sqrt(x[i]); break;
+            case OpCode::Clamp: for (unsigned int i = 0; i < count; ++i) d[i] = std::min(z[i], std::max(y[i], x[i])); break;
+        }
+    }
+
+    const float* r = registers + static_cast<size_t>(resultRegister) * blockSize;
+    for (unsigned int i = 0; i < count; ++i) {
+        out[i] = saturate(r[i]);
+    }
+}
+
+/**
+ * @brief Evaluates the expression over several images
+ * @param inputs Input images, inputs[0] is variable a
+ * @param dst Destination grayscale image
+ * @return true if successful, false otherwise
+ * @details Row bands are evaluated in parallel, each with its own register file.
+ *          Constant registers are filled once per band since no instruction writes them
+ */
+bool PixelExpression::evaluate(const std::vector<const Image*>& inputs, Image& dst) const {
+    if (registerCount == 0 || inputs.empty() || inputs.size() < variableCount) {
+        return false; // Not compiled or not enough images
+    }
+    for (const Image* img : inputs) {
+        if (img == nullptr || img->width() != inputs[0]->width() || img->height() != inputs[0]->height()) {
+            return false;
+        }
+    }
+
+    unsigned int width = inputs[0]->width();
+    unsigned int height = inputs[0]->height();
+    dst = Image(width, height);
+
+    if (folded) {
+        const Image& src = *inputs[0];
+        Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+            for (unsigned int y = begin; y < end; ++y) {
+                const unsigned char* in = src.row(y);
+                unsigned char* out = dst.row(y);
+                for (unsigned int x = 0; x < width; ++x) {
+                    out[x] = lut[in[x]];
+                }
+            }
+        });
+        return true;
+    }
+
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        std::vector<float> registers(static_cast<size_t>(registerCount) * blockSize);
+        for (const auto& c : constants) {
+            std::fill_n(&registers[static_cast<size_t>(c.first) * blockSize], blockSize, c.second);
+        }
+
+        const unsigned char* blockInputs[maxVariables] = {};
+        for (unsigned int y = begin; y < end; ++y) {
+            for (unsigned int x0 = 0; x0 < width; x0 += blockSize) {
+                unsigned int count = std::min(blockSize, width - x0);
+                for (unsigned int v = 0; v < variableCount; ++v) {
+                    blockInputs[v] = inputs[v]->row(y) + x0;
+                }
+                runBlock(blockInputs, count, registers.data(), dst.row(y) + x0);
+            }
+        }
+    });
+    return true;
+}
+
+/**
+ * @brief Evaluates the expression with src as variable a
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ */
+void PixelExpression::process(const Image& src, Image& dst) {
+    if (!evaluate({&src}, dst)) {
+        dst = Image();
+    }
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include <array>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class for evaluating per-pixel formulas over one or more grayscale images
+ * @details Expressions such as "clamp((a - b) * 1.5 + 20)" are compiled at run time
+ *          into bytecode for a small register machine. Every register holds a block of
+ *          pixels, so one instruction processes a whole block in a tight loop.
+ *
+ *          Syntax:
+ *          - variables a..h refer to the input images (a is the first one)
+ *          - numbers, + - * /, unary minus and parentheses
+ *          - functions: min(x,y), max(x,y), abs(x), sqrt(x), clamp(x) and clamp(x,lo,hi)
+ *
+ *          The result is saturated to [0,255] and truncated, like the Image arithmetic
+ *          operators. Expressions using at most one variable are folded into a
+ *          256-entry lookup table at compile time.
+ */
+class PixelExpression : public ImageProcessing {
+public:
+    static constexpr unsigned int maxVariables = 8;  ///< Number of variables (a..h)
+    static constexpr unsigned int blockSize = 256;   ///< Pixels per register
+
+private:
+    /**
+     * @brief Operation codes of the register machine
+     */
+    enum class OpCode { Load, Add, Sub, Mul, Div, Neg, Min, Max, Abs, Sqrt, Clamp };
+
+    /**
+     * @brief Single bytecode instruction: dst = op(a, b, c)
+     */
+    struct Instruction {
+        OpCode op;          ///< Operation
+        unsigned int dst;   ///< Destination register
+        unsigned int a;     ///< First operand register (variable index for Load)
+        unsigned int b;     ///< Second operand register
+        unsigned int c;     ///< Third operand register
+    };
+
+    std::vector<Instruction> program;             ///< Instructions executed per block
+    std::vector<std::pair<unsigned int, float>> constants; ///< Registers filled once with a constant
+    unsigned int registerCount;                   ///< Number of registers used
+    unsigned int resultRegister;                  ///< Register holding the result
+    unsigned int variableCount;                   ///< Highest used variable index + 1
+    bool folded;                                  ///< true if the expression is a lookup table
+    std::array<unsigned char, 256> lut;           ///< Lookup table for folded expressions
+    std::string errorMessage;                     ///< Description of the last compile error
+    std::string sourceText;                       ///< Expression being compiled
+
+    /**
+     * @brief Result of parsing a sub-expression
+     */
+    struct Value {
+        unsigned int reg;   ///< Register holding the value
+        bool isConstant;    ///< true if the value is known at compile time
+        float constant;     ///< Value if isConstant
+    };
+
+    size_t pos;  ///< Parser position in sourceText
+
+    /**
+     * @brief Parses a sum or difference
+     * @param out Parsed value
+     * @return true if successful
+     */
+    bool parseExpression(Value& out);
+
+    /**
+     * @brief Parses a product or quotient
+     * @param out Parsed value
+     * @return true if successful
+     */
+    bool parseTerm(Value& out);
+
+    /**
+     * @brief Parses an optionally negated primary expression
+     * @param out Parsed value
+     * @return true if successful
+     */
+    bool parseUnary(Value& out);
+
+    /**
+     * @brief Parses a number, variable, function call or parenthesized expression
+     * @param out Parsed value
+     * @return true if successful
+     */
+    bool parsePrimary(Value& out);
+
+    /**
+     * @brief Skips whitespace in the source text
+     */
+    void skipSpaces();
+
+    /**
+     * @brief Allocates a register holding a constant
+     * @param value Constant value
+     * @return Value referring to the register
+     */
+    Value makeConstant(float value);
+
+    /**
+     * @brief Emits an operation, folding it if all operands are constants
+     * @param op Operation
+     * @param a First operand
+     * @param b Second operand
+     * @param c Third operand
+     * @param operands Number of operands used (1 to 3)
+     * @return Value holding the result
+     */
+    Value emit(OpCode op, const Value& a, const Value& b, const Value& c, unsigned int operands);
+
+    /**
+     * @brief Records a compile error
+     * @param message Description of the error
+     * @return Always false
+     */
+    bool fail(const std::string& message);
+
+    /**
+     * @brief Runs the program on one block of pixels
+     * @param inputs Pointers to the block of each input variable
+     * @param count Number of pixels in the block
+     * @param registers Register file of registerCount * blockSize floats
+     * @param out Output pixels
+     */
+    void runBlock(const unsigned char* const* inputs, unsigned int count, float* registers, unsigned char* out) const;
+
+public:
+    /**
+     * @brief Default constructor
+     * @details Creates the expression "a" (identity)
+     */
+    PixelExpression();
+
+    /**
+     * @brief Constructor compiling an expression
+     * @param expression Source text of the expression
+     * @details Check error() to see if compilation succeeded
+     */
+    PixelExpression(const std::string& expression);
+
+    /**
+     * @brief Compiles an expression
+     * @param expression Source text of the expression
+     * @return true if compilation was successful, false otherwise (see error())
+     */
+    bool compile(const std::string& expression);
+
+    /**
+     * @brief Gets the last compile error
+     * @return Error message, empty if the last compilation succeeded
+     */
+    const std::string& error() const { return errorMessage; }
+
+    /**
+     * @brief Gets the number of input images the expression needs
+     * @return Highest used variable index + 1
+     */
+    unsigned int inputCount() const { return variableCount; }
+
+    /**
+     * @brief Checks if the expression was folded into a lookup table
+     * @return true if evaluation is a single table lookup per pixel
+     */
+    bool isLookupTable() const { return folded; }
+
+    /**
+     * @brief Evaluates the expression over several images
+     * @param inputs Input images, inputs[0] is variable a
+     * @param dst Destination grayscale image
+     * @return true if successful, false if inputs are missing or their dimensions differ
+     */
+    bool evaluate(const std::vector<const Image*>& inputs, Image& dst) const;
+
+    /**
+     * @brief Evaluates the expression with src as variable a
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image (empty if the expression needs more inputs)
+     */
+    void process(const Image& src, Image& dst) override;
+};
@@ -0,0 +1,197 @@
+#include "Projection.h"
+#include "Parallel.h"
+#include "WarpPerspective.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+const size_t maxSamples = 1u << 20;  ///< Ink pixels used for skew detection at most
+
+/**
+ * @brief Scores one candidate angle by the variance of the sheared row profile
+ * @param xs X coordinates of the ink pixels
+ * @param ys Y coordinates of the ink pixels
+ * @param angle Candidate angle in degrees
+ * @param bins Scratch buffer of profile bins
+ * @param offset Added to bin indices so they stay positive
+ * @return Sum of squared bin counts (higher means sharper text lines)
+ * @details Instead of rotating the image, every ink pixel (x,y) is dropped into the row
+ *          bin y - x tan(angle), which is the row it would land on after rotation
+ */
+double scoreAngle(const std::vector<float>& xs, const std::vector<float>& ys, double angle,
+                  std::vector<unsigned int>& bins, int offset) {
+    std::fill(bins.begin(), bins.end(), 0u);
+    float slope = static_cast<float>(std::tan(angle * pi / 180.0));
+    int last = static_cast<int>(bins.size()) - 1;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        int bin = static_cast<int>(ys[i] - xs[i] * slope + 0.5f) + offset;
+        ++bins[std::min(last, std::max(0, bin))];
+    }
+
+    double score = 0;
+    for (unsigned int count : bins) {
+        score += static_cast<double>(count) * count;
+    }
+    return score;
+}
+
+/**
+ * @brief Finds the best angle among evenly spaced candidates
+ * @param xs X coordinates of the ink pixels
+ * @param ys Y coordinates of the ink pixels
+ * @param from First candidate in degrees
+ * @param to Last candidate in degrees
+ * @param step Spacing of the candidates
+ * @param binCount Number of profile bins
+ * @param offset Added to bin indices so they stay positive
+ * @return Best candidate angle
+ */
+double searchAngles(const std::vector<float>& xs, const std::vector<float>& ys, double from, double to,
+                    double step, size_t binCount, int offset) {
+    unsigned int count = static_cast<unsigned int>(std::floor((to - from) / step + 0.5)) + 1;
+    std::vector<double> scores(count);
+
+    Parallel::forRange(count, [&](unsigned int begin, unsigned int end) {
+        std::vector<unsigned int> bins(binCount);
+        for (unsigned int i = begin; i < end; ++i) {
+            scores[i] = scoreAngle(xs, ys, from + i * step, bins, offset);
+        }
+    }, 1);
+
+    size_t best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+    return from + best * step;
+}
+
+}
+
+namespace Projection {
+
+/**
+ * @brief Computes row and column sums in one pass
+ * @param img Grayscale image
+ * @param rows Receives the sum of every row
+ * @param cols Receives the sum of every column
+ * @details Row sums are a reduction and column sums an element-wise add of the row into
+ *          the column vector, both plain loops the compiler vectorizes. Row bands keep
+ *          their own column sums which are merged at the end
+ */
+void profiles(const Image& img, std::vector<unsigned long long>& rows, std::vector<unsigned long long>& cols) {
+    unsigned int width = img.width();
+    rows.assign(img.height(), 0);
+    cols.assign(width, 0);
+    std::mutex colsMutex;
+
+    Parallel::forRange(img.height(), [&](unsigned int begin, unsigned int end) {
+        std::vector<unsigned long long> local(width, 0);
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned char* in = img.row(y);
+            unsigned long long sum = 0;
+            for (unsigned int x = 0; x < width; ++x) {
+                sum += in[x];
+                local[x] += in[x];
+            }
+            rows[y] = sum;
+        }
+
+        std::lock_guard<std::mutex> lock(colsMutex);
+        for (unsigned int x = 0; x < width; ++x) {
+            cols[x] += local[x];
+        }
+    });
+}
+
+/**
+ * @brief Detects the skew angle of a text page
+ * @param img Grayscale page
+ * @param maxAngle Largest skew to consider, in degrees
+ * @param precision Step of the final search, in degrees
+ * @param threshold Pixels darker than this are ink
+ * @return Angle in degrees
+ * @details Collects the ink pixels once (subsampled on very large pages), then searches
+ *          candidate angles coarse to fine: 1 degree steps over the whole range, then the
+ *          requested precision around the best coarse angle. Candidates are scored in parallel
+ */
+double detectSkew(const Image& img, double maxAngle, double precision, unsigned char threshold) {
+    unsigned int width = img.width();
+    unsigned int height = img.height();
+    if (width == 0 || height == 0) {
+        return 0.0;
+    }
+
+    size_t ink = 0;
+    for (unsigned int y = 0; y < height; ++y) {
+        const unsigned char* in = img.row(y);
+        for (unsigned int x = 0; x < width; ++x) {
+            ink += in[x] < threshold;
+        }
+    }
+    if (ink == 0) {
+        return 0.0;
+    }
+
+    size_t stride = (ink + maxSamples - 1) / maxSamples; // Keep every stride-th ink pixel
+    std::vector<float> xs, ys;
+    xs.reserve(ink / stride + 1);
+    ys.reserve(ink / stride + 1);
+    size_t seen = 0;
+    for (unsigned int y = 0; y < height; ++y) {
+        const unsigned char* in = img.row(y);
+        for (unsigned int x = 0; x < width; ++x) {
+            if (in[x] < threshold && seen++ % stride == 0) {
+                xs.push_back(static_cast<float>(x));
+                ys.push_back(static_cast<float>(y));
+            }
+        }
+    }
+
+    maxAngle = std::min(45.0, std::fabs(maxAngle));
+    precision = std::max(0.01, precision);
+    int offset = static_cast<int>(std::ceil(width * std::tan(maxAngle * pi / 180.0))) + 1;
+    size_t binCount = height + 2 * offset;
+
+    double coarseStep = std::max(precision, 1.0);
+    double coarse = searchAngles(xs, ys, -maxAngle, maxAngle, coarseStep, binCount, offset);
+    if (coarseStep <= precision) {
+        return coarse;
+    }
+    double from = std::max(-maxAngle, coarse - coarseStep);
+    double to = std::min(maxAngle, coarse + coarseStep);
+    return searchAngles(xs, ys, from, to, precision, binCount, offset);
+}
+
+}
+
+/**
+ * @brief Constructor for deskewing
+ * @param maxAngle Largest skew to consider, in degrees
+ * @param precision Step of the final search, in degrees
+ * @param threshold Pixels darker than this are ink
+ * @param background Value for areas uncovered by the rotation
+ */
+Deskew::Deskew(double maxAngle, double precision, unsigned char threshold, unsigned char background)
+    : maxAngle(maxAngle), precision(precision), threshold(threshold), background(background), lastAngle(0.0) {}
+
+/**
+ * @brief Straightens the page
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @details Rotates about the page center by the negative skew angle with WarpPerspective
+ */
+void Deskew::process(const Image& src, Image& dst) {
+    lastAngle = Projection::detectSkew(src, maxAngle, precision, threshold);
+
+    double a = -lastAngle * pi / 180.0;
+    double c = std::cos(a), s = std::sin(a);
+    double cx = (src.width() - 1) / 2.0, cy = (src.height() - 1) / 2.0;
+    std::array<double, 9> rotation = {
+        c, -s, cx - c * cx + s * cy,
+        s,  c, cy - s * cx - c * cy,
+        0,  0, 1
+    };
+
+    WarpPerspective warp(rotation, src.width(), src.height(), background);
+    warp.process(src, dst);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include <vector>
+
+/**
+ * @brief Namespace containing projection profiles and skew detection
+ */
+namespace Projection {
+    /**
+     * @brief Computes row and column sums in one pass
+     * @param img Grayscale image
+     * @param rows Receives the sum of every row (height entries)
+     * @param cols Receives the sum of every column (width entries)
+     */
+    void profiles(const Image& img, std::vector<unsigned long long>& rows, std::vector<unsigned long long>& cols);
+
+    /**
+     * @brief Detects the skew angle of a text page
+     * @param img Grayscale page, dark text on a light background
+     * @param maxAngle Largest skew to consider, in degrees (default: 15)
+     * @param precision Step of the final search, in degrees (default: 0.1)
+     * @param threshold Pixels darker than this are ink (default: 128)
+     * @return Angle in degrees, positive if text lines descend to the right
+     */
+    double detectSkew(const Image& img, double maxAngle = 15.0, double precision = 0.1, unsigned char threshold = 128);
+}
+
+/**
+ * @brief Class for straightening scanned text pages
+ * @details Detects the skew angle from projection profiles and rotates the page
+ *          about its center by the opposite angle
+ */
+class Deskew : public ImageProcessing {
+private:
+    double maxAngle;          ///< Largest skew to consider, in degrees
+    double precision;         ///< Step of the final search, in degrees
+    unsigned char threshold;  ///< Pixels darker than this are ink
+    unsigned char background; ///< Value for areas uncovered by the rotation
+    double lastAngle;         ///< Angle detected by the last call to process
+
+public:
+    /**
+     * @brief Constructor
+     * @param maxAngle Largest skew to consider, in degrees (default: 15)
+     * @param precision Step of the final search, in degrees (default: 0.1)
+     * @param threshold Pixels darker than this are ink (default: 128)
+     * @param background Value for areas uncovered by the rotation (default: 255, white paper)
+     */
+    Deskew(double maxAngle = 15.0, double precision = 0.1, unsigned char threshold = 128, unsigned char background = 255);
+
+    /**
+     * @brief Gets the angle detected by the last call to process
+     * @return Angle in degrees
+     */
+    double angle() const { return lastAngle; }
+
+    /**
+     * @brief Straightens the page
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image with the same size
+     */
+    void process(const Image& src, Image& dst) override;
+};
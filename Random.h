@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Namespace containing small, fast and reproducible random number generators
+ * @details Results depend only on the seed, never on the platform or thread count,
+ *          so generated data can be recreated exactly from a seed
+ */
+namespace Random {
+    /**
+     * @brief Advances a SplitMix64 state and returns the next value
+     * @param state Generator state, updated in place
+     * @return Well mixed 64-bit value
+     * @details Used to derive independent seeds, e.g. one per sample or per row
+     */
+    inline uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Scalar xorshift64* generator for parameters and decisions
+     */
+    class Generator {
+    private:
+        uint64_t state;  ///< Generator state, never zero
+
+    public:
+        /**
+         * @brief Constructor
+         * @param seed Seed value (any value, including 0)
+         */
+        explicit Generator(uint64_t seed) : state(splitMix64(seed) | 1) {}
+
+        /**
+         * @brief Gets the next 32 random bits
+         * @return Random value
+         */
+        uint32_t next() {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return static_cast<uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+        }
+
+        /**
+         * @brief Gets a uniform value in [lo, hi)
+         * @param lo Lower bound
+         * @param hi Upper bound
+         * @return Random value
+         */
+        double uniform(double lo = 0.0, double hi = 1.0) {
+            return lo + (hi - lo) * (next() * (1.0 / 4294967296.0));
+        }
+
+        /**
+         * @brief Gets a uniform integer in [0, n)
+         * @param n Number of possible values (must be > 0)
+         * @return Random value
+         */
+        uint32_t below(uint32_t n) {
+            return static_cast<uint32_t>((static_cast<uint64_t>(next()) * n) >> 32);
+        }
+    };
+
+    /**
+     * @brief Eight independent xorshift32 generators advanced in lockstep
+     * @details The lanes have no dependency on each other, so the compiler turns the
+     *          update loop into vector instructions. Used for filling whole rows with noise.
+     */
+    class LaneGenerator {
+    public:
+        static constexpr unsigned int lanes = 8;  ///< Number of independent lanes
+
+    private:
+        uint32_t state[lanes];  ///< Lane states, never zero
+
+    public:
+        /**
+         * @brief Constructor
+         * @param seed Seed value (any value, including 0)
+         */
+        explicit LaneGenerator(uint64_t seed) {
+            for (unsigned int k = 0; k < lanes; ++k) {
+                state[k] = static_cast<uint32_t>(splitMix64(seed)) | 1;
+            }
+        }
+
+        /**
+         * @brief Fills a buffer with random 32-bit values
+         * @param out Output buffer
+         * @param count Number of values
+         */
+        void fill(uint32_t* out, size_t count) {
+            uint32_t s[lanes];
+            for (unsigned int k = 0; k < lanes; ++k) {
+                s[k] = state[k];
+            }
+
+            size_t i = 0;
+            for (; i + lanes <= count; i += lanes) {
+                for (unsigned int k = 0; k < lanes; ++k) {
+                    s[k] ^= s[k] << 13;
+                    s[k] ^= s[k] >> 17;
+                    s[k] ^= s[k] << 5;
+                    out[i + k] = s[k];
+                }
+            }
+            for (unsigned int k = 0; i < count; ++i, ++k) {
+                s[k] ^= s[k] << 13;
+                s[k] ^= s[k] >> 17;
+                s[k] ^= s[k] << 5;
+                out[i] = s[k];
+            }
+
+            for (unsigned int k = 0; k < lanes; ++k) {
+                state[k] = s[k];
+            }
+        }
+
+        /**
+         * @brief Fills a buffer with approximately normal integer noise
+         * @param out Output buffer
+         * @param count Number of values
+         * @details Each value is the sum of the four bytes of one random word minus 510
+         *          (Irwin-Hall approximation): mean 0, standard deviation normalSigma,
+         *          bounded to [-510, 510]
+         */
+        void fillNormal(int* out, size_t count) {
+            uint32_t* bits = reinterpret_cast<uint32_t*>(out);
+            fill(bits, count);
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t v = bits[i];
+                out[i] = static_cast<int>((v & 0xFF) + ((v >> 8) & 0xFF) + ((v >> 16) & 0xFF) + (v >> 24)) - 510;
+            }
+        }
+
+        static constexpr double normalSigma = 147.8;  ///< Standard deviation of fillNormal values
+    };
+}
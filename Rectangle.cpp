@@ -135,8 +135,8 @@ Rectangle Rectangle::operator-(const Point& pt) const {
 Rectangle Rectangle::operator&(const Rectangle& other) const {
     int x1 = std::max(getX(), other.getX()); // Gives the corner of the most right
     int y1 = std::max(getY(), other.getY()); // and down rectangle
-    int x2 = std::min(getX() + getWidth(), other.getX() + other.getWidth());   //  Gives the corner of the most left
-    int y2 = std::min(getY() + getHeight(), other.getY() + other.getHeight()); //  and up(?) rectangle
+    int x2 = std::min(bottomRight.getX(), other.bottomRight.getX()); //  Gives the corner of the most left
+    int y2 = std::min(bottomRight.getY(), other.bottomRight.getY()); //  and up(?) rectangle, in signed coordinates
 
     if (x2 <= x1 || y2 <= y1) { // Width/heigth <= 0 so there is no valid overlap
         return Rectangle(); // Empty rectangle
@@ -153,8 +153,8 @@ Rectangle Rectangle::operator&(const Rectangle& other) const {
 Rectangle Rectangle::operator|(const Rectangle& other) const {
     int x1 = std::min(getX(), other.getX()); // Gives the corner of the most left
     int y1 = std::min(getY(), other.getY()); // and up rectangle
-    int x2 = std::max(getX() + getWidth(), other.getX() + other.getWidth());   //  Gives the corner of the most right
-    int y2 = std::max(getY() + getHeight(), other.getY() + other.getHeight()); //  and down rectangle
+    int x2 = std::max(bottomRight.getX(), other.bottomRight.getX()); //  Gives the corner of the most right
+    int y2 = std::max(bottomRight.getY(), other.bottomRight.getY()); //  and down rectangle
     
     return Rectangle(Point(x1, y1), Point(x2, y2));
 }
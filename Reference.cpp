@@ -0,0 +1,264 @@
+#include "Reference.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Reference {
+
+/**
+ * @brief Adjusts brightness and contrast pixel by pixel
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @param alpha Contrast factor
+ * @param beta Brightness offset
+ * @details new_value = alpha * old_value + beta, clamped to [0,255]
+ */
+void brightnessContrast(const Image& src, Image& dst, double alpha, int beta) {
+    dst = Image(src.width(), src.height());
+    for (unsigned int y = 0; y < src.height(); ++y) {
+        for (unsigned int x = 0; x < src.width(); ++x) {
+            dst.at(x, y) = std::min(255, std::max(0, static_cast<int>(src.at(x, y) * alpha + beta)));
+        }
+    }
+}
+
+/**
+ * @brief Applies gamma correction pixel by pixel
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @param gamma Gamma factor
+ * @details new_value = 255 * (old_value / 255)^gamma, clamped to 255
+ */
+void gamma(const Image& src, Image& dst, double gamma) {
+    dst = Image(src.width(), src.height());
+    for (unsigned int y = 0; y < src.height(); ++y) {
+        for (unsigned int x = 0; x < src.width(); ++x) {
+            dst.at(x, y) = std::min(255, static_cast<int>(255 * std::pow(src.at(x, y) / 255.0, gamma)));
+        }
+    }
+}
+
+/**
+ * @brief Convolves an image, skipping kernel taps outside the image
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @param kernel Kernel values
+ * @param width Kernel width
+ * @param height Kernel height
+ * @param scaling Function applied to each sum
+ * @details Scatter formulation: every source pixel adds its contribution to all output
+ *          pixels whose kernel covers it, instead of each output gathering its taps.
+ *          Taps outside the image never receive a source pixel, so they are skipped
+ *          implicitly. The sums are accumulated in a different order than the gather
+ *          loop, so results may differ by one gray level after truncation
+ */
+void convolution(const Image& src, Image& dst, const std::vector<double>& kernel, int width, int height,
+                 const std::function<double(double)>& scaling) {
+    int w = static_cast<int>(src.width());
+    int h = static_cast<int>(src.height());
+    int radiusX = width / 2;
+    int radiusY = height / 2;
+    std::vector<double> sums(static_cast<size_t>(w) * h, 0.0);
+
+    for (int sy = 0; sy < h; ++sy) {
+        for (int sx = 0; sx < w; ++sx) {
+            double value = src.at(sx, sy);
+            for (int ky = 0; ky < height; ++ky) {
+                for (int kx = 0; kx < width; ++kx) {
+                    int x = sx - kx + radiusX; // Output whose tap (kx, ky) lands on (sx, sy)
+                    int y = sy - ky + radiusY;
+                    if (x >= 0 && x < w && y >= 0 && y < h) {
+                        sums[static_cast<size_t>(y) * w + x] += value * kernel[ky * width + kx];
+                    }
+                }
+            }
+        }
+    }
+
+    dst = Image(src.width(), src.height());
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            dst.at(x, y) = std::min(255, std::max(0, static_cast<int>(scaling(sums[static_cast<size_t>(y) * w + x]))));
+        }
+    }
+}
+
+/**
+ * @brief Floyd-Steinberg dithering, one pixel after the other
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @param levels Number of output gray levels
+ * @details Works in level units with single precision, distributing 7/16, 3/16, 5/16
+ *          and 1/16 of each error to the right and lower neighbours
+ */
+void floydSteinberg(const Image& src, Image& dst, unsigned int levels) {
+    unsigned int width = src.width();
+    unsigned int height = src.height();
+    dst = Image(width, height);
+
+    float scale = (levels - 1) / 255.0f;
+    float step = 255.0f / (levels - 1);
+    float top = static_cast<float>(levels - 1);
+
+    ImageF work(width, height);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            work.at(x, y) = src.at(x, y) * scale;
+        }
+    }
+
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            float v = work.at(x, y);
+            float q = std::min(top, std::max(0.0f, static_cast<float>(static_cast<int>(v + 0.5f))));
+            float err = v - q;
+            dst.at(x, y) = static_cast<unsigned char>(q * step + 0.5f);
+
+            if (x + 1 < width) {
+                work.at(x + 1, y) += err * (7.0f / 16);
+            }
+            if (y + 1 < height) {
+                if (x > 0) {
+                    work.at(x - 1, y + 1) += err * (3.0f / 16);
+                }
+                work.at(x, y + 1) += err * (5.0f / 16);
+                if (x + 1 < width) {
+                    work.at(x + 1, y + 1) += err * (1.0f / 16);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Counts gray values one pixel at a time
+ * @param img Grayscale image
+ * @return Histogram
+ */
+Histogram::Counts histogram(const Image& img) {
+    Histogram::Counts counts{};
+    for (unsigned int y = 0; y < img.height(); ++y) {
+        for (unsigned int x = 0; x < img.width(); ++x) {
+            ++counts[img.at(x, y)];
+        }
+    }
+    return counts;
+}
+
+/**
+ * @brief Remaps an image with double precision bilinear interpolation
+ * @param src Source grayscale image
+ * @param mapX Source X coordinates
+ * @param mapY Source Y coordinates
+ * @param dst Destination grayscale image
+ * @param border Value for pixels mapping outside the source
+ * @details Neighbours past the last row or column are clamped to the edge
+ */
+void remap(const Image& src, const ImageF& mapX, const ImageF& mapY, Image& dst, unsigned char border) {
+    dst = Image(mapX.width(), mapX.height());
+    for (unsigned int y = 0; y < mapX.height(); ++y) {
+        for (unsigned int x = 0; x < mapX.width(); ++x) {
+            double sx = mapX.at(x, y);
+            double sy = mapY.at(x, y);
+            if (!(sx >= 0 && sy >= 0 && sx < src.width() && sy < src.height())) {
+                dst.at(x, y) = border;
+                continue;
+            }
+
+            unsigned int x0 = static_cast<unsigned int>(sx);
+            unsigned int y0 = static_cast<unsigned int>(sy);
+            unsigned int x1 = std::min(x0 + 1, src.width() - 1);
+            unsigned int y1 = std::min(y0 + 1, src.height() - 1);
+            double fx = sx - x0;
+            double fy = sy - y0;
+            double top = src.at(x0, y0) * (1 - fx) + src.at(x1, y0) * fx;
+            double bottom = src.at(x0, y1) * (1 - fx) + src.at(x1, y1) * fx;
+            dst.at(x, y) = static_cast<unsigned char>(std::lround(top * (1 - fy) + bottom * fy));
+        }
+    }
+}
+
+/**
+ * @brief Reduces an image by an integer factor
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @param factor Reduction factor
+ * @param average true to average blocks, false to subsample
+ * @details Blocks cut by the right or bottom edge average the pixels they cover
+ */
+void downsample(const Image& src, Image& dst, unsigned int factor, bool average) {
+    dst = Image((src.width() + factor - 1) / factor, (src.height() + factor - 1) / factor);
+    for (unsigned int oy = 0; oy < dst.height(); ++oy) {
+        for (unsigned int ox = 0; ox < dst.width(); ++ox) {
+            if (!average) {
+                dst.at(ox, oy) = src.at(ox * factor, oy * factor);
+                continue;
+            }
+            unsigned long long sum = 0, count = 0;
+            for (unsigned int y = oy * factor; y < std::min(src.height(), (oy + 1) * factor); ++y) {
+                for (unsigned int x = ox * factor; x < std::min(src.width(), (ox + 1) * factor); ++x) {
+                    sum += src.at(x, y);
+                    ++count;
+                }
+            }
+            dst.at(ox, oy) = static_cast<unsigned char>((sum + count / 2) / count);
+        }
+    }
+}
+
+
+/**
+ * @brief Composes tiles into a canvas one tile pixel at a time
+ * @param tiles Tile images in placement order
+ * @param offsets Canvas position of the top-left pixel of each tile
+ * @param width Canvas width
+ * @param height Canvas height
+ * @param feather Feather width
+ * @param background Value of pixels no tile covers
+ * @param dst Destination grayscale image
+ * @details Walks every pixel of every tile with 64-bit canvas coordinates and skips the
+ *          ones outside the canvas, instead of clipping rectangles
+ */
+void mosaic(const std::vector<const Image*>& tiles, const std::vector<Point>& offsets, unsigned int width,
+            unsigned int height, unsigned int feather, unsigned char background, Image& dst) {
+    dst = Image(width, height);
+    std::vector<unsigned long long> sum(static_cast<size_t>(width) * height, 0);
+    std::vector<unsigned long long> weight(sum.size(), 0);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            dst.at(x, y) = background;
+        }
+    }
+
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        const Image& tile = *tiles[t];
+        for (unsigned int ty = 0; ty < tile.height(); ++ty) {
+            for (unsigned int tx = 0; tx < tile.width(); ++tx) {
+                long long cx = static_cast<long long>(offsets[t].getX()) + tx;
+                long long cy = static_cast<long long>(offsets[t].getY()) + ty;
+                if (cx < 0 || cy < 0 || cx >= width || cy >= height) {
+                    continue;
+                }
+                if (feather == 0) {
+                    dst.at(static_cast<unsigned int>(cx), static_cast<unsigned int>(cy)) = tile.at(tx, ty);
+                    continue;
+                }
+                unsigned long long wx = std::min(std::min(tx, tile.width() - 1 - tx) + 1, feather);
+                unsigned long long wy = std::min(std::min(ty, tile.height() - 1 - ty) + 1, feather);
+                size_t i = static_cast<size_t>(cy) * width + static_cast<size_t>(cx);
+                sum[i] += wx * wy * tile.at(tx, ty);
+                weight[i] += wx * wy;
+            }
+        }
+    }
+
+    for (unsigned int y = 0; y < height && feather > 0; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            if (weight[i] > 0) {
+                dst.at(x, y) = static_cast<unsigned char>((sum[i] + weight[i] / 2) / weight[i]);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Image.h"
+#include "ImageBuffer.h"
+#include "Histogram.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Namespace containing straightforward reference implementations of optimized operators
+ * @details These are the plain per-pixel loops the optimized code started from: no lookup
+ *          tables, no threads, no fixed point. They define the expected results and are
+ *          used by the differential checker to validate every fast path.
+ */
+namespace Reference {
+    /**
+     * @brief Adjusts brightness and contrast pixel by pixel
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     * @param alpha Contrast factor
+     * @param beta Brightness offset
+     */
+    void brightnessContrast(const Image& src, Image& dst, double alpha, int beta);
+
+    /**
+     * @brief Applies gamma correction pixel by pixel
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     * @param gamma Gamma factor
+     */
+    void gamma(const Image& src, Image& dst, double gamma);
+
+    /**
+     * @brief Convolves an image by scattering each source pixel, skipping kernel taps outside the image
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     * @param kernel Kernel values, row after row
+     * @param width Kernel width
+     * @param height Kernel height
+     * @param scaling Function applied to each sum before clamping
+     */
+    void convolution(const Image& src, Image& dst, const std::vector<double>& kernel, int width, int height,
+                     const std::function<double(double)>& scaling);
+
+    /**
+     * @brief Floyd-Steinberg dithering, one pixel after the other
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image
+     * @param levels Number of output gray levels
+     */
+    void floydSteinberg(const Image& src, Image& dst, unsigned int levels);
+
+    /**
+     * @brief Counts gray values one pixel at a time
+     * @param img Grayscale image
+     * @return Histogram
+     */
+    Histogram::Counts histogram(const Image& img);
+
+    /**
+     * @brief Remaps an image with double precision bilinear interpolation
+     * @param src Source grayscale image
+     * @param mapX Source X coordinate for each output pixel
+     * @param mapY Source Y coordinate for each output pixel
+     * @param dst Destination grayscale image
+     * @param border Value for pixels mapping outside the source
+     */
+    void remap(const Image& src, const ImageF& mapX, const ImageF& mapY, Image& dst, unsigned char border);
+
+    /**
+     * @brief Reduces an image by an integer factor
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image of ceil(width / factor) x ceil(height / factor)
+     * @param factor Reduction factor
+     * @param average true to average blocks (rounded), false to keep every factor-th pixel
+     */
+    void downsample(const Image& src, Image& dst, unsigned int factor, bool average);
+
+    /**
+     * @brief Composes tiles into a canvas one tile pixel at a time
+     * @param tiles Tile images in placement order
+     * @param offsets Canvas position of the top-left pixel of each tile
+     * @param width Canvas width
+     * @param height Canvas height
+     * @param feather Feather width, 0 to let later tiles overwrite earlier ones
+     * @param background Value of pixels no tile covers
+     * @param dst Destination grayscale image
+     */
+    void mosaic(const std::vector<const Image*>& tiles, const std::vector<Point>& offsets, unsigned int width,
+                unsigned int height, unsigned int feather, unsigned char background, Image& dst);
+}
@@ -0,0 +1,124 @@
+#include "Remap.h"
+#include "Parallel.h"
+#include "Interpolation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const unsigned int tileWidth = 64;   ///< Output tile width in pixels
+const unsigned int tileHeight = 32;  ///< Output tile height in pixels
+}
+
+/**
+ * @brief Constructor compiling a map
+ * @param mapX Source X coordinate for each output pixel
+ * @param mapY Source Y coordinate for each output pixel
+ * @param border Value for pixels mapping outside the source
+ * @details Coordinates are rounded to 1/256 pixel. The integer part is packed into one
+ *          32-bit word, the fractions into one 16-bit word. Coordinates outside the
+ *          valid 16-bit range are marked invalid and produce the border value
+ */
+Remap::Remap(const ImageF& mapX, const ImageF& mapY, unsigned char border)
+    : mapWidth(mapX.width()), mapHeight(mapX.height()), border(border) {
+    if (mapY.width() != mapWidth || mapY.height() != mapHeight) {
+        mapWidth = mapHeight = 0; // Mismatched maps give an empty result
+        return;
+    }
+
+    size_t count = static_cast<size_t>(mapWidth) * mapHeight;
+    coords.resize(count);
+    weights.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        float sx = mapX.data()[i];
+        float sy = mapY.data()[i];
+        if (!(sx >= 0.0f && sy >= 0.0f && sx < 65535.0f && sy < 65535.0f)) { // Also catches NaN
+            coords[i] = invalid;
+            weights[i] = 0;
+            continue;
+        }
+
+        int fixedX = static_cast<int>(sx * 256.0f + 0.5f);
+        int fixedY = static_cast<int>(sy * 256.0f + 0.5f);
+        coords[i] = (static_cast<unsigned int>(fixedY >> 8) << 16) | static_cast<unsigned int>(fixedX >> 8);
+        weights[i] = static_cast<unsigned short>(((fixedX & 0xFF) << 8) | (fixedY & 0xFF));
+    }
+}
+
+/**
+ * @brief Creates the map undoing lens distortion
+ * @param width Width of the camera images
+ * @param height Height of the camera images
+ * @param lens Camera and distortion coefficients
+ * @param border Value for pixels mapping outside the source
+ * @return Remap turning distorted frames into undistorted ones
+ * @details For every undistorted output pixel computes where it lies in the distorted frame:
+ *          x' = x(1 + k1 r^2 + k2 r^4 + k3 r^6) + 2 p1 x y + p2 (r^2 + 2x^2)
+ *          y' = y(1 + k1 r^2 + k2 r^4 + k3 r^6) + p1 (r^2 + 2y^2) + 2 p2 x y
+ */
+Remap Remap::undistort(unsigned int width, unsigned int height, const LensDistortion& lens, unsigned char border) {
+    ImageF mapX(width, height);
+    ImageF mapY(width, height);
+
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int v = begin; v < end; ++v) {
+            double y = (v - lens.cy) / lens.fy;
+            for (unsigned int u = 0; u < width; ++u) {
+                double x = (u - lens.cx) / lens.fx;
+                double r2 = x * x + y * y;
+                double radial = 1 + r2 * (lens.k1 + r2 * (lens.k2 + r2 * lens.k3));
+                double xd = x * radial + 2 * lens.p1 * x * y + lens.p2 * (r2 + 2 * x * x);
+                double yd = y * radial + lens.p1 * (r2 + 2 * y * y) + 2 * lens.p2 * x * y;
+                mapX.at(u, v) = static_cast<float>(xd * lens.fx + lens.cx);
+                mapY.at(u, v) = static_cast<float>(yd * lens.fy + lens.cy);
+            }
+        }
+    });
+    return Remap(mapX, mapY, border);
+}
+
+/**
+ * @brief Applies the map to a grayscale image
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @details Each output pixel is a bilinear blend in 8-bit fixed point of the four
+ *          source pixels around the compiled coordinate
+ */
+void Remap::process(const Image& src, Image& dst) {
+    dst = Image(mapWidth, mapHeight);
+    if (mapWidth == 0 || mapHeight == 0) {
+        return;
+    }
+
+    unsigned int srcWidth = src.width();
+    unsigned int srcHeight = src.height();
+    unsigned int tileRows = (mapHeight + tileHeight - 1) / tileHeight;
+
+    Parallel::forRange(tileRows, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int ty = begin; ty < end; ++ty) {
+            unsigned int y0 = ty * tileHeight;
+            unsigned int y1 = std::min(mapHeight, y0 + tileHeight);
+
+            for (unsigned int x0 = 0; x0 < mapWidth; x0 += tileWidth) {
+                unsigned int x1 = std::min(mapWidth, x0 + tileWidth);
+
+                for (unsigned int y = y0; y < y1; ++y) {
+                    const unsigned int* c = &coords[static_cast<size_t>(y) * mapWidth];
+                    const unsigned short* w = &weights[static_cast<size_t>(y) * mapWidth];
+                    unsigned char* out = dst.row(y);
+
+                    for (unsigned int x = x0; x < x1; ++x) {
+                        unsigned int sx = c[x] & 0xFFFF;
+                        unsigned int sy = c[x] >> 16;
+                        if (c[x] == invalid || sx >= srcWidth || sy >= srcHeight) {
+                            out[x] = border;
+                            continue;
+                        }
+
+                        out[x] = Interpolation::bilinear(src, sx, sy, w[x] >> 8, w[x] & 0xFF);
+                    }
+                }
+            }
+        }
+    }, 1);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include "ImageBuffer.h"
+#include <vector>
+
+/**
+ * @brief Structure describing a camera with radial and tangential lens distortion
+ * @details Uses the Brown-Conrady model: k1, k2, k3 are radial, p1, p2 tangential
+ *          coefficients, all on normalized coordinates ((u - cx) / fx, (v - cy) / fy)
+ */
+struct LensDistortion {
+    double fx = 1.0;  ///< Focal length in pixels along X
+    double fy = 1.0;  ///< Focal length in pixels along Y
+    double cx = 0.0;  ///< Principal point X
+    double cy = 0.0;  ///< Principal point Y
+    double k1 = 0.0;  ///< Radial coefficient r^2
+    double k2 = 0.0;  ///< Radial coefficient r^4
+    double k3 = 0.0;  ///< Radial coefficient r^6
+    double p1 = 0.0;  ///< Tangential coefficient 1
+    double p2 = 0.0;  ///< Tangential coefficient 2
+};
+
+/**
+ * @brief Class for geometric remapping driven by a precomputed map
+ * @details dst(x,y) = src(mapX(x,y), mapY(x,y)) with bilinear interpolation.
+ *          The float maps are compiled once into packed integer source coordinates
+ *          and 8-bit fractional weights, so applying the same map to every frame
+ *          costs one gather of four pixels and an integer blend per output pixel.
+ *          The output is processed in tiles, tile rows in parallel.
+ */
+class Remap : public ImageProcessing {
+private:
+    static constexpr unsigned int invalid = 0xFFFFFFFFu;  ///< Marks output pixels mapping outside the source
+
+    unsigned int mapWidth;               ///< Width of the output image
+    unsigned int mapHeight;              ///< Height of the output image
+    std::vector<unsigned int> coords;    ///< Source (y << 16 | x) of the top-left neighbour
+    std::vector<unsigned short> weights; ///< Fractional parts (fx << 8 | fy) in 1/256 pixels
+    unsigned char border;                ///< Value for pixels mapping outside the source
+
+public:
+    /**
+     * @brief Constructor compiling a map
+     * @param mapX Source X coordinate for each output pixel
+     * @param mapY Source Y coordinate for each output pixel (same size as mapX)
+     * @param border Value for pixels mapping outside the source (default: 0)
+     * @details Source coordinates are limited to 16 bits
+     */
+    Remap(const ImageF& mapX, const ImageF& mapY, unsigned char border = 0);
+
+    /**
+     * @brief Creates the map undoing lens distortion
+     * @param width Width of the camera images
+     * @param height Height of the camera images
+     * @param lens Camera and distortion coefficients
+     * @param border Value for pixels mapping outside the source (default: 0)
+     * @return Remap turning distorted frames into undistorted ones
+     */
+    static Remap undistort(unsigned int width, unsigned int height, const LensDistortion& lens, unsigned char border = 0);
+
+    /**
+     * @brief Applies the map to a grayscale image
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image with the size of the map
+     */
+    void process(const Image& src, Image& dst) override;
+};
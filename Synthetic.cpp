@@ -0,0 +1,244 @@
+#include "Synthetic.h"
+#include "Drawing.h"
+#include "Parallel.h"
+#include "Random.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Structure holding one random shape
+ */
+struct Shape {
+    int kind;             ///< 0: filled rectangle, 1: circle, 2: line
+    Point a;              ///< Top-left corner, center or start point
+    Point b;              ///< Bottom-right corner or end point (center + radius along x for circles)
+    unsigned char value;  ///< Gray value
+};
+
+/**
+ * @brief Hashes a seed and two indices into 64 random bits
+ * @param seed Seed value
+ * @param i First index
+ * @param j Second index
+ * @return Random value
+ */
+inline uint64_t hash(uint64_t seed, uint64_t i, uint64_t j) {
+    uint64_t state = seed ^ (i * 0x9E3779B97F4A7C15ull) ^ (j * 0xC2B2AE3D27D4EB4Full);
+    return Random::splitMix64(state);
+}
+
+/**
+ * @brief Draws the random shape list of an image
+ * @param spec Image description
+ * @return Shapes in drawing order
+ */
+std::vector<Shape> makeShapes(const SyntheticSpec& spec) {
+    std::vector<Shape> shapes(spec.shapeCount);
+    Random::Generator rng(spec.seed);
+    unsigned int w = std::max(1u, spec.width), h = std::max(1u, spec.height);
+    unsigned int maxSize = std::max(2u, std::min(w, h) / 4);
+
+    for (Shape& s : shapes) {
+        s.kind = static_cast<int>(rng.below(3));
+        s.a = Point(rng.below(w), rng.below(h));
+        int size = 1 + static_cast<int>(rng.below(maxSize));
+        if (s.kind == 2) {
+            s.b = Point(s.a.getX() + static_cast<int>(rng.below(2 * size)) - size,
+                        s.a.getY() + static_cast<int>(rng.below(2 * size)) - size);
+        } else {
+            s.b = Point(s.a.getX() + size, s.a.getY() + static_cast<int>(1 + rng.below(maxSize)));
+        }
+        s.value = static_cast<unsigned char>(rng.below(256));
+    }
+    return shapes;
+}
+
+/**
+ * @brief Computes one row of a pattern
+ * @param spec Image description
+ * @param y Image row
+ * @param out Row of spec.width pixels
+ * @param words Scratch buffer of at least (width + 3) / 4 words
+ */
+void fillRow(const SyntheticSpec& spec, unsigned int y, unsigned char* out, uint32_t* words) {
+    unsigned int width = spec.width;
+
+    switch (spec.pattern) {
+    case SyntheticSpec::Pattern::Noise: {
+        uint64_t rowSeed = spec.seed ^ (static_cast<uint64_t>(y) * 0xD1B54A32D192ED03ull);
+        Random::LaneGenerator rng(rowSeed);
+        rng.fill(words, (width + 3) / 4);
+        std::memcpy(out, words, width);
+        break;
+    }
+    case SyntheticSpec::Pattern::Gradient: {
+        double a = spec.angle * 3.14159265358979323846 / 180.0;
+        double c = std::cos(a), s = std::sin(a);
+        double w = std::max(1u, width) - 1.0, h = std::max(1u, spec.height) - 1.0;
+        double lo = std::min(0.0, c * w) + std::min(0.0, s * h);
+        double hi = std::max(0.0, c * w) + std::max(0.0, s * h);
+        double scale = hi > lo ? 255.0 / (hi - lo) : 0.0;
+        double v = (s * y - lo) * scale + 0.5;
+        double step = c * scale;
+        for (unsigned int x = 0; x < width; ++x) {
+            out[x] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, v + step * x)));
+        }
+        break;
+    }
+    case SyntheticSpec::Pattern::Checkerboard: {
+        unsigned int cell = std::max(1u, spec.cellSize);
+        unsigned int parity = (y / cell) & 1;
+        for (unsigned int x = 0; x < width; ++x) {
+            out[x] = ((x / cell) & 1) ^ parity ? 255 : 0;
+        }
+        break;
+    }
+    case SyntheticSpec::Pattern::Text: {
+        // Glyphs are 5x7 dots of dot x dot pixels, advancing 6 dots, lines 12 dots apart
+        unsigned int dot = std::max(1u, spec.cellSize / 12);
+        unsigned int margin = 4 * 6 * dot;
+        std::memset(out, 255, width);
+        if (y < margin || y >= spec.height - std::min(spec.height, margin)) {
+            break;
+        }
+        unsigned int line = (y - margin) / (12 * dot);
+        unsigned int dotRow = (y - margin) % (12 * dot) / dot;
+        if (dotRow >= 7 || width <= 2 * margin) {
+            break;
+        }
+        unsigned int columns = (width - 2 * margin) / (6 * dot);
+        unsigned int lineLength = columns - static_cast<unsigned int>(hash(spec.seed, line, ~0ull) % (columns / 3 + 1));
+
+        for (unsigned int g = 0; g < lineLength; ++g) {
+            uint64_t bits = hash(spec.seed, line, g);
+            if (bits % 6 == 0) {
+                continue; // Space between words
+            }
+            unsigned int glyphRow = static_cast<unsigned int>(bits >> (8 + 5 * dotRow)) & 0x1F;
+            unsigned char* glyph = out + margin + g * 6 * dot;
+            for (unsigned int k = 0; k < 5; ++k) {
+                if (glyphRow >> k & 1) {
+                    std::memset(glyph + k * dot, 0, dot);
+                }
+            }
+        }
+        break;
+    }
+    case SyntheticSpec::Pattern::Shapes:
+        std::memset(out, 128, width);
+        break;
+    }
+}
+
+/**
+ * @brief Generates a band of rows with a precomputed shape list
+ * @param spec Image description
+ * @param y0 First image row of the band
+ * @param band Destination band
+ * @param shapes Shapes drawn over the band
+ */
+void fillBand(const SyntheticSpec& spec, unsigned int y0, Image& band, const std::vector<Shape>& shapes) {
+    Parallel::forRange(band.height(), [&](unsigned int begin, unsigned int end) {
+        std::vector<uint32_t> words((spec.width + 3) / 4 + 1);
+        for (unsigned int y = begin; y < end; ++y) {
+            fillRow(spec, y0 + y, band.row(y), words.data());
+        }
+    });
+
+    // Shapes are drawn in the same order in every band, translated into band coordinates
+    int top = static_cast<int>(y0);
+    int bottom = top + static_cast<int>(band.height());
+    for (const Shape& s : shapes) {
+        int radius = s.b.getX() - s.a.getX();
+        int minY = s.kind == 1 ? s.a.getY() - radius : std::min(s.a.getY(), s.b.getY());
+        int maxY = s.kind == 1 ? s.a.getY() + radius : std::max(s.a.getY(), s.b.getY());
+        if (maxY < top || minY >= bottom) {
+            continue;
+        }
+        Point a(s.a.getX(), s.a.getY() - top);
+        Point b(s.b.getX(), s.b.getY() - top);
+        switch (s.kind) {
+        case 0:
+            Drawing::fillRectangle(band, Rectangle(a, b), s.value);
+            break;
+        case 1:
+            Drawing::drawCircle(band, a, radius, s.value);
+            break;
+        default:
+            Drawing::drawLine(band, a, b, s.value);
+            break;
+        }
+    }
+}
+
+}
+
+namespace Synthetic {
+
+/**
+ * @brief Generates a whole image
+ * @param spec Image description
+ * @return Generated image
+ */
+Image generate(const SyntheticSpec& spec) {
+    Image img(spec.width, spec.height);
+    generateBand(spec, 0, img);
+    return img;
+}
+
+/**
+ * @brief Generates a band of rows
+ * @param spec Image description
+ * @param y0 First image row of the band
+ * @param band Destination band
+ */
+void generateBand(const SyntheticSpec& spec, unsigned int y0, Image& band) {
+    std::vector<Shape> shapes;
+    if (spec.pattern == SyntheticSpec::Pattern::Shapes) {
+        shapes = makeShapes(spec);
+    }
+    fillBand(spec, y0, band, shapes);
+}
+
+/**
+ * @brief Writes an image to a P5 PGM file band by band
+ * @param spec Image description
+ * @param path Output file path
+ * @param bandHeight Rows generated and written at a time
+ * @return true if successful
+ * @details The shape list is drawn once; each band is generated in parallel and
+ *          written with one call per row
+ */
+bool write(const SyntheticSpec& spec, const std::string& path, unsigned int bandHeight) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "P5\n" << spec.width << " " << spec.height << "\n255\n";
+
+    std::vector<Shape> shapes;
+    if (spec.pattern == SyntheticSpec::Pattern::Shapes) {
+        shapes = makeShapes(spec);
+    }
+
+    bandHeight = std::max(1u, bandHeight);
+    Image band;
+    for (unsigned int y0 = 0; y0 < spec.height; y0 += bandHeight) {
+        unsigned int rows = std::min(bandHeight, spec.height - y0);
+        if (band.height() != rows) {
+            band = Image(spec.width, rows);
+        }
+        fillBand(spec, y0, band, shapes);
+        for (unsigned int y = 0; y < rows; ++y) {
+            file.write(reinterpret_cast<const char*>(band.row(y)), spec.width);
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+}
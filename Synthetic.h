@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Image.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Structure describing a synthetic test image
+ */
+struct SyntheticSpec {
+    /**
+     * @brief Kind of generated content
+     */
+    enum class Pattern {
+        Noise,         ///< Uniform random gray values
+        Gradient,      ///< Linear ramp from 0 to 255
+        Checkerboard,  ///< Alternating squares of 0 and 255
+        Text,          ///< Lines of random 5x7 glyphs on white, with ragged right margins
+        Shapes         ///< Random filled rectangles, circles and lines on gray
+    };
+
+    Pattern pattern = Pattern::Noise;  ///< Kind of content
+    unsigned int width = 0;            ///< Image width
+    unsigned int height = 0;           ///< Image height
+    uint64_t seed = 0;                 ///< Seed for the random patterns
+    unsigned int cellSize = 32;        ///< Checkerboard square size, text line height
+    double angle = 0.0;                ///< Gradient direction in degrees (0: left to right)
+    unsigned int shapeCount = 100;     ///< Number of shapes
+};
+
+/**
+ * @brief Namespace generating reproducible synthetic images for benchmarks and load tests
+ * @details Every pixel depends only on the spec, never on the band layout or thread
+ *          count, so an image written in bands is identical to one generated at once.
+ *          Rows are generated in parallel; random rows come from lane-parallel xorshift
+ *          generators seeded per row.
+ */
+namespace Synthetic {
+    /**
+     * @brief Generates a whole image
+     * @param spec Image description
+     * @return Generated image
+     */
+    Image generate(const SyntheticSpec& spec);
+
+    /**
+     * @brief Generates a band of rows
+     * @param spec Image description
+     * @param y0 First image row of the band
+     * @param band Destination with the width of the image; its height gives the number of rows
+     */
+    void generateBand(const SyntheticSpec& spec, unsigned int y0, Image& band);
+
+    /**
+     * @brief Writes an image to a P5 PGM file band by band
+     * @param spec Image description
+     * @param path Output file path
+     * @param bandHeight Rows generated and written at a time (default: 256)
+     * @return true if successful, false if the file could not be written
+     * @details Memory use is one band, so images larger than memory can be produced
+     */
+    bool write(const SyntheticSpec& spec, const std::string& path, unsigned int bandHeight = 256);
+}
@@ -0,0 +1,216 @@
+#include "TensorExport.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Source positions and weights of every output coordinate of one axis
+ * @details Output i reads index[k] with weight[k] for k in [begin[i], begin[i + 1])
+ */
+struct Filter {
+    std::vector<unsigned int> begin;   ///< First tap of each output coordinate, plus the end
+    std::vector<unsigned int> index;   ///< Source index of each tap
+    std::vector<float> weight;         ///< Weight of each tap
+};
+
+/**
+ * @brief Fills the resampling filter of one axis
+ * @param start First source index of the crop
+ * @param length Source length of the crop
+ * @param size Output length
+ * @param filter Filter receiving size output coordinates
+ * @details Up to a reduction of 2 every output is a bilinear blend of two pixels, with
+ *          pixel-center alignment clamped to the crop. Beyond that every output averages
+ *          the source interval it covers, weighting partly covered pixels by their
+ *          overlap. No pixel outside the crop is ever read
+ */
+void makeFilter(unsigned int start, unsigned int length, unsigned int size, Filter& filter) {
+    filter.begin.assign(1, 0);
+    filter.index.clear();
+    filter.weight.clear();
+    float ratio = static_cast<float>(length) / size;
+
+    for (unsigned int i = 0; i < size; ++i) {
+        if (ratio <= 2.0f) {
+            float pos = std::min(std::max((i + 0.5f) * ratio - 0.5f, 0.0f), static_cast<float>(length - 1));
+            unsigned int p0 = static_cast<unsigned int>(pos);
+            float w = pos - p0;
+            filter.index.push_back(start + p0);
+            filter.weight.push_back(1.0f - w);
+            filter.index.push_back(start + std::min(p0 + 1, length - 1));
+            filter.weight.push_back(w);
+        } else {
+            float lo = i * ratio;
+            float hi = std::min((i + 1) * ratio, static_cast<float>(length));
+            for (unsigned int p = static_cast<unsigned int>(lo); p < length && p < hi; ++p) {
+                float overlap = std::min(hi, p + 1.0f) - std::max(lo, static_cast<float>(p));
+                if (overlap > 0.0f) {
+                    filter.index.push_back(start + p);
+                    filter.weight.push_back(overlap / (hi - lo));
+                }
+            }
+        }
+        filter.begin.push_back(static_cast<unsigned int>(filter.index.size()));
+    }
+}
+
+/**
+ * @brief Checks a normalization and folds it into per-channel gains and offsets
+ * @param norm Normalization
+ * @param channels Number of channels
+ * @param divisor Extra divisor (the quantization step for int8, 1 otherwise)
+ * @param gains Receives pixel * gain + offset per channel
+ * @param offsets Receives the offsets
+ * @return true if mean and stddev have one or channels values and no stddev is zero
+ */
+bool foldNormalization(const TensorNormalization& norm, unsigned int channels, float divisor,
+                       std::vector<float>& gains, std::vector<float>& offsets) {
+    if ((norm.mean.size() != 1 && norm.mean.size() != channels) ||
+        (norm.stddev.size() != 1 && norm.stddev.size() != channels)) {
+        return false;
+    }
+    gains.resize(channels);
+    offsets.resize(channels);
+    for (unsigned int c = 0; c < channels; ++c) {
+        float mean = norm.mean[norm.mean.size() == 1 ? 0 : c];
+        float stddev = norm.stddev[norm.stddev.size() == 1 ? 0 : c];
+        if (stddev == 0.0f) {
+            return false;
+        }
+        gains[c] = norm.scale / (stddev * divisor);
+        offsets[c] = -mean / (stddev * divisor);
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the fused crop, resize and normalization for all crops
+ * @param img Source grayscale image
+ * @param rois Crops
+ * @param width Output width
+ * @param height Output height
+ * @param channels Number of channels
+ * @param out Output buffer
+ * @param convert Function turning a resampled pixel value and a channel into an output element
+ * @return true if successful
+ * @details Each output row is accumulated from the source rows of its vertical taps,
+ *          each filtered horizontally, and then written once per channel
+ */
+template <typename T, typename Convert>
+bool exportBatch(const Image& img, const std::vector<Rectangle>& rois, unsigned int width, unsigned int height,
+                 unsigned int channels, T* out, Convert convert) {
+    if (width == 0 || height == 0 || channels == 0) {
+        return false;
+    }
+    for (const Rectangle& r : rois) {
+        if (r.getX() < 0 || r.getY() < 0 || r.getWidth() <= 0 || r.getHeight() <= 0 ||
+            r.getX() + r.getWidth() > img.width() || r.getY() + r.getHeight() > img.height()) {
+            return false;
+        }
+    }
+
+    size_t plane = static_cast<size_t>(width) * height;
+
+    Parallel::forRange(static_cast<unsigned int>(rois.size()), [&](unsigned int begin, unsigned int end) {
+        Filter columns;
+        Filter rows;
+        std::vector<float> line(width);
+
+        for (unsigned int i = begin; i < end; ++i) {
+            const Rectangle& r = rois[i];
+            makeFilter(r.getX(), r.getWidth(), width, columns);
+            makeFilter(r.getY(), r.getHeight(), height, rows);
+
+            T* dst = out + i * plane * channels;
+            for (unsigned int y = 0; y < height; ++y) {
+                std::fill(line.begin(), line.end(), 0.0f);
+                for (unsigned int k = rows.begin[y]; k < rows.begin[y + 1]; ++k) {
+                    const unsigned char* src = img.row(rows.index[k]);
+                    float wy = rows.weight[k];
+                    for (unsigned int x = 0; x < width; ++x) {
+                        float sum = 0.0f;
+                        for (unsigned int t = columns.begin[x]; t < columns.begin[x + 1]; ++t) {
+                            sum += src[columns.index[t]] * columns.weight[t];
+                        }
+                        line[x] += sum * wy;
+                    }
+                }
+
+                for (unsigned int c = 0; c < channels; ++c) {
+                    T* row = dst + c * plane + static_cast<size_t>(y) * width;
+                    for (unsigned int x = 0; x < width; ++x) {
+                        row[x] = convert(line[x], c);
+                    }
+                }
+            }
+        }
+    }, 1);
+    return true;
+}
+
+}
+
+namespace TensorExport {
+
+/**
+ * @brief Gets the number of elements of a batch
+ * @param count Number of crops
+ * @param width Output width of each crop
+ * @param height Output height of each crop
+ * @param channels Number of channels
+ * @return Number of elements
+ */
+size_t batchSize(size_t count, unsigned int width, unsigned int height, unsigned int channels) {
+    return count * channels * height * static_cast<size_t>(width);
+}
+
+/**
+ * @brief Exports crops as a float32 NCHW batch
+ * @param img Source grayscale image
+ * @param rois Crops
+ * @param width Output width of each crop
+ * @param height Output height of each crop
+ * @param out Output buffer
+ * @param norm Normalization
+ * @param channels Number of channels
+ * @return true if successful
+ * @details The normalization is folded into one multiply-add per element
+ */
+bool toFloat(const Image& img, const std::vector<Rectangle>& rois, unsigned int width, unsigned int height,
+             float* out, const TensorNormalization& norm, unsigned int channels) {
+    std::vector<float> gains, offsets;
+    if (!foldNormalization(norm, channels, 1.0f, gains, offsets)) {
+        return false;
+    }
+    return exportBatch(img, rois, width, height, channels, out, [&](float v, unsigned int c) {
+        return v * gains[c] + offsets[c];
+    });
+}
+
+/**
+ * @brief Exports crops as a symmetric int8 quantized NCHW batch
+ * @param img Source grayscale image
+ * @param rois Crops
+ * @param width Output width of each crop
+ * @param height Output height of each crop
+ * @param out Output buffer
+ * @param quantScale Quantization step
+ * @param norm Normalization
+ * @param channels Number of channels
+ * @return true if successful
+ */
+bool toInt8(const Image& img, const std::vector<Rectangle>& rois, unsigned int width, unsigned int height,
+            signed char* out, float quantScale, const TensorNormalization& norm, unsigned int channels) {
+    std::vector<float> gains, offsets;
+    if (quantScale == 0.0f || !foldNormalization(norm, channels, quantScale, gains, offsets)) {
+        return false;
+    }
+    return exportBatch(img, rois, width, height, channels, out, [&](float v, unsigned int c) {
+        float q = std::nearbyint(v * gains[c] + offsets[c]);
+        return static_cast<signed char>(std::min(127.0f, std::max(-128.0f, q)));
+    });
+}
+
+}
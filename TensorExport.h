@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Image.h"
+#include "Rectangle.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Structure describing how pixels are mapped to tensor values
+ * @details value = (pixel * scale - mean[c]) / stddev[c] for channel c. mean and stddev
+ *          hold either one value used for every channel or one value per channel
+ */
+struct TensorNormalization {
+    float scale = 1.0f / 255.0f;            ///< Factor applied to raw pixel values
+    std::vector<float> mean = {0.0f};       ///< Mean subtracted after scaling, per channel
+    std::vector<float> stddev = {1.0f};     ///< Standard deviation divided by after subtracting the mean, per channel
+
+    /**
+     * @brief Gets the normalization of ImageNet-trained models
+     * @return Pixels scaled to [0,1] with the ImageNet RGB means and standard deviations
+     */
+    static TensorNormalization imageNet() {
+        TensorNormalization norm;
+        norm.mean = {0.485f, 0.456f, 0.406f};
+        norm.stddev = {0.229f, 0.224f, 0.225f};
+        return norm;
+    }
+};
+
+/**
+ * @brief Namespace converting image crops into batches for neural network inference
+ * @details Every crop is resized to the same size, normalized and stored in NCHW order
+ *          (crop, channel, row, column) in one contiguous caller-provided buffer. Each
+ *          axis is resampled bilinearly, or by area averaging where it shrinks by more
+ *          than a factor of 2, so large crops reduced to small tensors do not alias.
+ *          Crop, resize, normalization and layout conversion happen in a single pass per
+ *          crop; crops are processed in parallel. The grayscale plane is replicated when
+ *          more than one channel is requested, each channel with its own normalization.
+ */
+namespace TensorExport {
+    /**
+     * @brief Gets the number of elements of a batch
+     * @param count Number of crops
+     * @param width Output width of each crop
+     * @param height Output height of each crop
+     * @param channels Number of channels
+     * @return count * channels * height * width
+     */
+    size_t batchSize(size_t count, unsigned int width, unsigned int height, unsigned int channels = 1);
+
+    /**
+     * @brief Exports crops as a float32 NCHW batch
+     * @param img Source grayscale image
+     * @param rois Crops, all inside the image and non-empty
+     * @param width Output width of each crop
+     * @param height Output height of each crop
+     * @param out Buffer of batchSize(rois.size(), width, height, channels) floats
+     * @param norm Normalization (default: scale to [0,1])
+     * @param channels Number of channels (default: 1)
+     * @return true if successful, false if a crop is invalid, the output size is zero or
+     *         the normalization has neither one nor channels values
+     */
+    bool toFloat(const Image& img, const std::vector<Rectangle>& rois, unsigned int width, unsigned int height,
+                 float* out, const TensorNormalization& norm = TensorNormalization(), unsigned int channels = 1);
+
+    /**
+     * @brief Exports crops as a symmetric int8 quantized NCHW batch
+     * @param img Source grayscale image
+     * @param rois Crops, all inside the image and non-empty
+     * @param width Output width of each crop
+     * @param height Output height of each crop
+     * @param out Buffer of batchSize(rois.size(), width, height, channels) bytes
+     * @param quantScale Quantization step: q = round(value / quantScale), saturated to [-128,127]
+     * @param norm Normalization applied before quantization (default: scale to [0,1])
+     * @param channels Number of channels (default: 1)
+     * @return true if successful, false if a crop is invalid, the output size or quantScale is zero
+     *         or the normalization has neither one nor channels values
+     */
+    bool toInt8(const Image& img, const std::vector<Rectangle>& rois, unsigned int width, unsigned int height,
+                signed char* out, float quantScale, const TensorNormalization& norm = TensorNormalization(),
+                unsigned int channels = 1);
+}
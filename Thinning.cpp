@@ -0,0 +1,154 @@
+#include "Thinning.h"
+#include "Parallel.h"
+#include <vector>
+
+/**
+ * @brief Constructor for thinning
+ * @param method Thinning algorithm
+ * @details Builds the deletion tables. Bit k of a neighbourhood code is the pixel
+ *          P(k+2) of the usual notation: P2 north, then clockwise to P9 north-west
+ */
+Thinning::Thinning(Method method) : method(method) {
+    for (int code = 0; code < 256; ++code) {
+        int p[10] = {0, 0};
+        for (int k = 0; k < 8; ++k) {
+            p[k + 2] = (code >> k) & 1;
+        }
+
+        for (int sub = 0; sub < 2; ++sub) {
+            bool remove = false;
+            if (method == Method::ZhangSuen) {
+                int b = 0, a = 0;
+                for (int k = 2; k <= 9; ++k) {
+                    b += p[k];
+                    a += (p[k] == 0 && p[k == 9 ? 2 : k + 1] == 1); // 0 -> 1 transitions around the pixel
+                }
+                bool sides = sub == 0 ? (p[2] * p[4] * p[6] == 0 && p[4] * p[6] * p[8] == 0)
+                                      : (p[2] * p[4] * p[8] == 0 && p[2] * p[6] * p[8] == 0);
+                remove = b >= 2 && b <= 6 && a == 1 && sides;
+            } else {
+                int c = (!p[2] && (p[3] || p[4])) + (!p[4] && (p[5] || p[6]))
+                      + (!p[6] && (p[7] || p[8])) + (!p[8] && (p[9] || p[2]));
+                int n1 = (p[9] || p[2]) + (p[3] || p[4]) + (p[5] || p[6]) + (p[7] || p[8]);
+                int n2 = (p[2] || p[3]) + (p[4] || p[5]) + (p[6] || p[7]) + (p[8] || p[9]);
+                int n = n1 < n2 ? n1 : n2;
+                int m = sub == 0 ? ((p[6] || p[7] || !p[9]) && p[8]) : ((p[2] || p[3] || !p[5]) && p[4]);
+                remove = c == 1 && n >= 2 && n <= 3 && m == 0;
+            }
+            deletable[sub][code] = remove;
+        }
+    }
+}
+
+/**
+ * @brief Thins the foreground of a binary image
+ * @param src Source image
+ * @param dst Destination image
+ * @details Works on a zero-padded 0/1 grid. Every subiteration has a list of candidate
+ *          pixels; their deletion decisions are computed in parallel from the grid as it
+ *          was before the subiteration (the decisions act as the second buffer), then
+ *          applied. Foreground neighbours of deleted pixels become candidates for both
+ *          subiterations again. Thinning ends when no candidates are left
+ */
+void Thinning::process(const Image& src, Image& dst) {
+    unsigned int width = src.width();
+    unsigned int height = src.height();
+    dst = Image::zeros(width, height);
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    size_t W = static_cast<size_t>(width) + 2;
+    size_t H = static_cast<size_t>(height) + 2;
+    std::vector<unsigned char> grid(W * H, 0);
+    for (unsigned int y = 0; y < height; ++y) {
+        const unsigned char* in = src.row(y);
+        unsigned char* g = &grid[(y + 1) * W + 1];
+        for (unsigned int x = 0; x < width; ++x) {
+            g[x] = in[x] != 0;
+        }
+    }
+
+    const long offsets[8] = { // P2..P9
+        -static_cast<long>(W), -static_cast<long>(W) + 1, 1, static_cast<long>(W) + 1,
+        static_cast<long>(W), static_cast<long>(W) - 1, -1, -static_cast<long>(W) - 1
+    };
+
+    std::vector<size_t> candidates[2];
+    std::vector<unsigned char> queued[2] = {std::vector<unsigned char>(W * H, 0), std::vector<unsigned char>(W * H, 0)};
+    auto enqueue = [&](size_t idx) {
+        for (int s = 0; s < 2; ++s) {
+            if (!queued[s][idx]) {
+                queued[s][idx] = 1;
+                candidates[s].push_back(idx);
+            }
+        }
+    };
+
+    for (size_t y = 1; y + 1 < H; ++y) { // Initial frontier: foreground pixels touching background
+        for (size_t x = 1; x + 1 < W; ++x) {
+            size_t idx = y * W + x;
+            if (!grid[idx]) {
+                continue;
+            }
+            for (long off : offsets) {
+                if (!grid[idx + off]) {
+                    enqueue(idx);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<unsigned char> remove;
+    for (int sub = 0; !candidates[0].empty() || !candidates[1].empty(); sub ^= 1) {
+        std::vector<size_t> current;
+        current.swap(candidates[sub]);
+        for (size_t idx : current) {
+            queued[sub][idx] = 0;
+        }
+
+        remove.assign(current.size(), 0);
+        const std::array<bool, 256>& table = deletable[sub];
+        Parallel::forRange(static_cast<unsigned int>(current.size()), [&](unsigned int begin, unsigned int end) {
+            for (unsigned int i = begin; i < end; ++i) {
+                size_t idx = current[i];
+                if (!grid[idx]) {
+                    continue;
+                }
+                unsigned int code = 0;
+                for (int k = 0; k < 8; ++k) {
+                    code |= static_cast<unsigned int>(grid[idx + offsets[k]]) << k;
+                }
+                remove[i] = table[code];
+            }
+        }, 1024);
+
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (remove[i]) {
+                grid[current[i]] = 0;
+            }
+        }
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (!remove[i]) {
+                continue;
+            }
+            for (long off : offsets) { // Neighbourhood of these pixels changed
+                size_t n = current[i] + off;
+                if (grid[n]) {
+                    enqueue(n);
+                }
+            }
+        }
+    }
+
+    Parallel::forRange(height, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned char* g = &grid[(y + 1) * W + 1];
+            unsigned char* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = g[x] ? 255 : 0;
+            }
+        }
+    });
+}
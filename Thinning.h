@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include <array>
+
+/**
+ * @brief Class for skeletonization of binary masks
+ * @details Runs the Zhang-Suen or Guo-Hall thinning subiterations. The deletion rule of
+ *          each subiteration is tabulated over all 256 neighbourhood patterns. Only pixels
+ *          whose neighbourhood changed since they were last examined are visited again,
+ *          so late iterations only touch the shrinking frontier instead of the whole image.
+ */
+class Thinning : public ImageProcessing {
+public:
+    /**
+     * @brief Thinning algorithm
+     */
+    enum class Method {
+        ZhangSuen,  ///< Zhang & Suen (1984)
+        GuoHall     ///< Guo & Hall (1989), keeps diagonal lines thinner
+    };
+
+private:
+    Method method;                                ///< Algorithm in use
+    std::array<std::array<bool, 256>, 2> deletable; ///< Deletion rule per subiteration and neighbourhood code
+
+public:
+    /**
+     * @brief Constructor
+     * @param method Thinning algorithm (default: Zhang-Suen)
+     */
+    Thinning(Method method = Method::ZhangSuen);
+
+    /**
+     * @brief Thins the foreground of a binary image to a one pixel wide skeleton
+     * @param src Source image, every non-zero pixel is foreground
+     * @param dst Destination image, skeleton pixels are 255, the rest 0
+     */
+    void process(const Image& src, Image& dst) override;
+};
@@ -0,0 +1,157 @@
+#include "ToneMapping.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * @brief Constructor for tone mapping
+ * @details Linear mapping, equivalent to taking the high byte with rounding
+ */
+ToneMapping::ToneMapping() : lut(65536) {
+    for (unsigned int v = 0; v < 65536; ++v) {
+        lut[v] = static_cast<unsigned char>((v * 255 + 32767) / 65535);
+    }
+}
+
+/**
+ * @brief Creates a window/level mapping
+ * @param center Input value mapped to mid gray
+ * @param width Input range mapped to [0,255]
+ * @return Tone mapping
+ * @details Values below center - width/2 become black, above center + width/2 white
+ */
+ToneMapping ToneMapping::windowLevel(double center, double width) {
+    ToneMapping tm;
+    width = std::max(1.0, width);
+    double low = center - width / 2;
+    for (unsigned int v = 0; v < 65536; ++v) {
+        double mapped = (v - low) * 255.0 / width;
+        tm.lut[v] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, mapped + 0.5)));
+    }
+    return tm;
+}
+
+/**
+ * @brief Creates a gamma curve
+ * @param gamma Gamma correction factor
+ * @param maxValue Input value mapped to white
+ * @return Tone mapping
+ */
+ToneMapping ToneMapping::gamma(double gamma, unsigned short maxValue) {
+    ToneMapping tm;
+    double top = std::max<unsigned short>(1, maxValue);
+    for (unsigned int v = 0; v < 65536; ++v) {
+        double mapped = 255 * pow(std::min(1.0, v / top), gamma);
+        tm.lut[v] = static_cast<unsigned char>(std::min(255.0, mapped + 0.5));
+    }
+    return tm;
+}
+
+/**
+ * @brief Creates a logarithmic curve
+ * @param maxValue Input value mapped to white
+ * @return Tone mapping
+ * @details Compresses highlights, useful for data with a large dynamic range
+ */
+ToneMapping ToneMapping::logarithmic(unsigned short maxValue) {
+    ToneMapping tm;
+    double norm = log1p(static_cast<double>(std::max<unsigned short>(1, maxValue)));
+    for (unsigned int v = 0; v < 65536; ++v) {
+        double mapped = 255 * log1p(static_cast<double>(v)) / norm;
+        tm.lut[v] = static_cast<unsigned char>(std::min(255.0, mapped + 0.5));
+    }
+    return tm;
+}
+
+/**
+ * @brief Fuses an 8-bit point operation into the mapping
+ * @param op Operation applied to the 8-bit result
+ * @return Reference to this mapping
+ * @throws std::invalid_argument if op is content-dependent
+ * @details lut[v] = op(lut[v]), so the fused curve still costs one lookup per pixel
+ */
+ToneMapping& ToneMapping::then(const PointOperation& op) {
+    if (op.isContentDependent()) {
+        throw std::invalid_argument("ToneMapping: content-dependent operations cannot be fused");
+    }
+    std::array<unsigned char, 256> next = op.lookupTable();
+    for (unsigned char& v : lut) {
+        v = next[v];
+    }
+    return *this;
+}
+
+/**
+ * @brief Maps a 16-bit image to an 8-bit image
+ * @param src Source 16-bit image
+ * @param dst Destination grayscale image
+ * @details Row bands are processed in parallel
+ */
+void ToneMapping::process(const Image16& src, Image& dst) const {
+    dst = Image(src.width(), src.height());
+
+    unsigned int width = src.width();
+    const unsigned char* table = lut.data();
+    Parallel::forRange(src.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned short* in = src.row(y);
+            unsigned char* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = table[in[x]];
+            }
+        }
+    });
+}
+
+namespace BitDepth {
+
+/**
+ * @brief Expands an 8-bit image to 16 bits
+ * @param src Source grayscale image
+ * @param dst Destination 16-bit image
+ * @param maxValue Output value for white
+ * @details new_value = round(old_value * maxValue / 255), in 16.16 fixed point
+ *          (exact for the default maxValue, where the factor is 257)
+ */
+void expand(const Image& src, Image16& dst, unsigned short maxValue) {
+    dst = Image16(src.width(), src.height());
+
+    unsigned int width = src.width();
+    unsigned int factor = static_cast<unsigned int>((static_cast<unsigned long long>(maxValue) << 16) / 255); // maxValue/255 in 16.16
+    Parallel::forRange(src.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const unsigned char* in = src.row(y);
+            unsigned short* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                out[x] = static_cast<unsigned short>((in[x] * factor + 0x8000u) >> 16);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Converts a float image to 8 bits with saturation
+ * @param src Source float image
+ * @param dst Destination grayscale image
+ * @param scale Factor applied before rounding
+ * @param offset Value added after scaling
+ */
+void saturate(const ImageF& src, Image& dst, float scale, float offset) {
+    dst = Image(src.width(), src.height());
+
+    unsigned int width = src.width();
+    Parallel::forRange(src.height(), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int y = begin; y < end; ++y) {
+            const float* in = src.row(y);
+            unsigned char* out = dst.row(y);
+            for (unsigned int x = 0; x < width; ++x) {
+                float v = std::min(255.0f, std::max(0.0f, in[x] * scale + offset + 0.5f));
+                out[x] = static_cast<unsigned char>(v);
+            }
+        }
+    });
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include "ImageBuffer.h"
+#include <vector>
+
+/**
+ * @brief Class for mapping 16-bit images to 8 bits
+ * @details Works like an 8-bit PointOperation, but over all 65536 input values:
+ *          the curve (window/level, gamma, logarithmic) is tabulated once and every
+ *          pixel costs one table lookup. 8-bit point operations can be fused into the
+ *          same table with then(), so a whole tone curve stays a single pass.
+ */
+class ToneMapping {
+private:
+    std::vector<unsigned char> lut;  ///< 65536-entry lookup table
+
+public:
+    /**
+     * @brief Constructor
+     * @details Creates a linear mapping of [0,65535] to [0,255]
+     */
+    ToneMapping();
+
+    /**
+     * @brief Creates a window/level mapping
+     * @param center Input value mapped to mid gray (level)
+     * @param width Input range mapped to [0,255] (window)
+     * @return Tone mapping clamping values outside the window to black or white
+     */
+    static ToneMapping windowLevel(double center, double width);
+
+    /**
+     * @brief Creates a gamma curve
+     * @param gamma Gamma correction factor
+     * @param maxValue Input value mapped to white (default: 65535)
+     * @return Tone mapping new_value = 255 * (old_value/maxValue)^gamma
+     */
+    static ToneMapping gamma(double gamma, unsigned short maxValue = 65535);
+
+    /**
+     * @brief Creates a logarithmic curve
+     * @param maxValue Input value mapped to white (default: 65535)
+     * @return Tone mapping new_value = 255 * log(1 + old_value) / log(1 + maxValue)
+     */
+    static ToneMapping logarithmic(unsigned short maxValue = 65535);
+
+    /**
+     * @brief Fuses an 8-bit point operation into the mapping
+     * @param op Operation applied to the 8-bit result
+     * @return Reference to this mapping
+     * @throws std::invalid_argument if op is content-dependent (e.g. histogram matching),
+     *         since its table needs an 8-bit image that does not exist yet
+     */
+    ToneMapping& then(const PointOperation& op);
+
+    /**
+     * @brief Maps a single 16-bit value
+     * @param value Source value
+     * @return Resulting gray value
+     */
+    unsigned char apply(unsigned short value) const { return lut[value]; }
+
+    /**
+     * @brief Maps a 16-bit image to an 8-bit image
+     * @param src Source 16-bit image
+     * @param dst Destination grayscale image
+     */
+    void process(const Image16& src, Image& dst) const;
+};
+
+/**
+ * @brief Namespace containing plain bit-depth conversions
+ * @details All conversions are branch-free loops over row bands processed in parallel
+ */
+namespace BitDepth {
+    /**
+     * @brief Expands an 8-bit image to 16 bits
+     * @param src Source grayscale image
+     * @param dst Destination 16-bit image
+     * @param maxValue Output value for white (default: 65535, i.e. v * 257)
+     */
+    void expand(const Image& src, Image16& dst, unsigned short maxValue = 65535);
+
+    /**
+     * @brief Converts a float image to 8 bits with saturation
+     * @param src Source float image
+     * @param dst Destination grayscale image
+     * @param scale Factor applied before rounding (default: 255, for [0,1] input)
+     * @param offset Value added after scaling (default: 0)
+     * @details new_value = clamp(round(old_value * scale + offset), 0, 255)
+     */
+    void saturate(const ImageF& src, Image& dst, float scale = 255.0f, float offset = 0.0f);
+}
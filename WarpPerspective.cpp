@@ -0,0 +1,158 @@
+#include "WarpPerspective.h"
+#include "Interpolation.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const unsigned int tileWidth = 64;   ///< Output tile width in pixels
+const unsigned int tileHeight = 32;  ///< Output tile height in pixels
+}
+
+/**
+ * @brief Constructor for perspective warping
+ * @param matrix Source -> destination homography
+ * @param width Width of the output image
+ * @param height Height of the output image
+ * @param border Value for pixels mapping outside the source
+ * @details Inverts the matrix with the adjugate; the scale of a homography does not matter,
+ *          so dividing by the determinant is only used to normalize it. The sign is then
+ *          fixed so that the homogeneous W is positive at the center of the output
+ */
+WarpPerspective::WarpPerspective(const std::array<double, 9>& matrix, unsigned int width, unsigned int height, unsigned char border)
+    : inverse{}, outWidth(width), outHeight(height), border(border), valid(false) {
+    const std::array<double, 9>& m = matrix;
+    double det = m[0] * (m[4] * m[8] - m[5] * m[7])
+               - m[1] * (m[3] * m[8] - m[5] * m[6])
+               + m[2] * (m[3] * m[7] - m[4] * m[6]);
+    if (std::fabs(det) < 1e-12) {
+        return;
+    }
+
+    inverse[0] = (m[4] * m[8] - m[5] * m[7]) / det;
+    inverse[1] = (m[2] * m[7] - m[1] * m[8]) / det;
+    inverse[2] = (m[1] * m[5] - m[2] * m[4]) / det;
+    inverse[3] = (m[5] * m[6] - m[3] * m[8]) / det;
+    inverse[4] = (m[0] * m[8] - m[2] * m[6]) / det;
+    inverse[5] = (m[2] * m[3] - m[0] * m[5]) / det;
+    inverse[6] = (m[3] * m[7] - m[4] * m[6]) / det;
+    inverse[7] = (m[1] * m[6] - m[0] * m[7]) / det;
+    inverse[8] = (m[0] * m[4] - m[1] * m[3]) / det;
+
+    // H and -H are the same mapping; pick the sign with W > 0 at the output center,
+    // so the W > 0 test in process() only rejects points behind the camera
+    double centerW = inverse[6] * 0.5 * width + inverse[7] * 0.5 * height + inverse[8];
+    if (centerW < 0) {
+        for (double& v : inverse) {
+            v = -v;
+        }
+    }
+    valid = true;
+}
+
+/**
+ * @brief Computes the homography mapping four points onto four other points
+ * @param src Four source points
+ * @param dst Four destination points
+ * @param matrix Resulting homography
+ * @return true if successful, false if the points are degenerate
+ * @details Solves the 8x8 linear system for h0..h7 (h8 = 1) with Gaussian elimination
+ *          and partial pivoting
+ */
+bool WarpPerspective::fromPoints(const Point src[4], const Point dst[4], std::array<double, 9>& matrix) {
+    double a[8][9] = {};
+    for (int i = 0; i < 4; ++i) {
+        double x = src[i].getX(), y = src[i].getY();
+        double u = dst[i].getX(), v = dst[i].getY();
+        double rowU[9] = {x, y, 1, 0, 0, 0, -x * u, -y * u, u};
+        double rowV[9] = {0, 0, 0, x, y, 1, -x * v, -y * v, v};
+        std::copy(rowU, rowU + 9, a[2 * i]);
+        std::copy(rowV, rowV + 9, a[2 * i + 1]);
+    }
+
+    for (int col = 0; col < 8; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < 8; ++r) {
+            if (std::fabs(a[r][col]) > std::fabs(a[pivot][col])) {
+                pivot = r;
+            }
+        }
+        if (std::fabs(a[pivot][col]) < 1e-12) {
+            return false; // Three or more points on a line
+        }
+        std::swap(a[col], a[pivot]);
+
+        for (int r = 0; r < 8; ++r) {
+            if (r == col) {
+                continue;
+            }
+            double f = a[r][col] / a[col][col];
+            for (int c = col; c < 9; ++c) {
+                a[r][c] -= f * a[col][c];
+            }
+        }
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        matrix[i] = a[i][8] / a[i][i];
+    }
+    matrix[8] = 1.0;
+    return true;
+}
+
+/**
+ * @brief Warps the grayscale image
+ * @param src Source grayscale image
+ * @param dst Destination grayscale image
+ * @details For output pixel (x,y) the source position is (X/W, Y/W) with
+ *          X = i0 x + i1 y + i2, Y = i3 x + i4 y + i5, W = i6 x + i7 y + i8.
+ *          X, Y and W are set up once per row of a tile and then stepped by i0, i3, i6.
+ *          The divide is a single precision reciprocal shared by both coordinates,
+ *          which is accurate to far below the 1/256 pixel sampling grid
+ */
+void WarpPerspective::process(const Image& src, Image& dst) {
+    if (!valid) {
+        dst = Image();
+        return;
+    }
+    dst = Image(outWidth, outHeight);
+
+    const std::array<double, 9>& h = inverse;
+    float srcWidth = static_cast<float>(src.width());
+    float srcHeight = static_cast<float>(src.height());
+    unsigned int tileRows = (outHeight + tileHeight - 1) / tileHeight;
+
+    Parallel::forRange(tileRows, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int ty = begin; ty < end; ++ty) {
+            unsigned int y0 = ty * tileHeight;
+            unsigned int y1 = std::min(outHeight, y0 + tileHeight);
+
+            for (unsigned int x0 = 0; x0 < outWidth; x0 += tileWidth) {
+                unsigned int x1 = std::min(outWidth, x0 + tileWidth);
+
+                for (unsigned int y = y0; y < y1; ++y) {
+                    double X = h[0] * x0 + h[1] * y + h[2]; // Full multiply once per row of the tile
+                    double Y = h[3] * x0 + h[4] * y + h[5];
+                    double W = h[6] * x0 + h[7] * y + h[8];
+                    unsigned char* out = dst.row(y);
+
+                    for (unsigned int x = x0; x < x1; ++x, X += h[0], Y += h[3], W += h[6]) {
+                        float inv = 1.0f / static_cast<float>(W);
+                        float sx = static_cast<float>(X) * inv;
+                        float sy = static_cast<float>(Y) * inv;
+                        if (!(sx >= 0.0f && sy >= 0.0f && sx < srcWidth && sy < srcHeight && W > 0)) { // Also catches NaN
+                            out[x] = border;
+                            continue;
+                        }
+
+                        int fixedX = static_cast<int>(sx * 256.0f + 0.5f);
+                        int fixedY = static_cast<int>(sy * 256.0f + 0.5f);
+                        unsigned int ix = std::min(static_cast<unsigned int>(fixedX >> 8), src.width() - 1);
+                        unsigned int iy = std::min(static_cast<unsigned int>(fixedY >> 8), src.height() - 1);
+                        out[x] = Interpolation::bilinear(src, ix, iy, fixedX & 0xFF, fixedY & 0xFF);
+                    }
+                }
+            }
+        }
+    }, 1);
+}
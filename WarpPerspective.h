@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ImageProcessing.h"
+#include "Point.h"
+#include <array>
+
+/**
+ * @brief Class for perspective (homography) warping of a grayscale image
+ * @details The matrix maps source to destination coordinates; it is inverted once so every
+ *          output pixel can look up its source position. Along a row the homogeneous
+ *          coordinates change by a constant step, so they are updated with three additions
+ *          per pixel instead of a full 3x3 multiply. Sampling is bilinear in fixed point
+ *          and the output is processed in tiles, tile rows in parallel.
+ */
+class WarpPerspective : public ImageProcessing {
+private:
+    std::array<double, 9> inverse;  ///< Destination -> source homography, row-major
+    unsigned int outWidth;          ///< Width of the output image
+    unsigned int outHeight;         ///< Height of the output image
+    unsigned char border;           ///< Value for pixels mapping outside the source
+    bool valid;                     ///< false if the matrix could not be inverted
+
+public:
+    /**
+     * @brief Constructor
+     * @param matrix Source -> destination homography, row-major 3x3
+     * @param width Width of the output image
+     * @param height Height of the output image
+     * @param border Value for pixels mapping outside the source (default: 0)
+     */
+    WarpPerspective(const std::array<double, 9>& matrix, unsigned int width, unsigned int height, unsigned char border = 0);
+
+    /**
+     * @brief Computes the homography mapping four points onto four other points
+     * @param src Four source points (e.g. detected page corners)
+     * @param dst Four destination points (e.g. corners of the output page)
+     * @param matrix Resulting source -> destination homography, row-major 3x3
+     * @return true if successful, false if the points are degenerate
+     */
+    static bool fromPoints(const Point src[4], const Point dst[4], std::array<double, 9>& matrix);
+
+    /**
+     * @brief Warps the grayscale image
+     * @param src Source grayscale image
+     * @param dst Destination grayscale image with the configured size (empty if the matrix is singular)
+     */
+    void process(const Image& src, Image& dst) override;
+};
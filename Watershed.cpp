@@ -0,0 +1,226 @@
+#include "Watershed.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace {
+
+/**
+ * @brief Priority queue for 8-bit priorities
+ * @details One FIFO per gray level, kept as linked lists in a flat array indexed by pixel,
+ *          so pushing and popping are O(1) and nothing is allocated while flooding.
+ *          Every pixel is queued at most once.
+ */
+class BucketQueue {
+private:
+    std::vector<size_t> next;  ///< Next pixel in the same bucket
+    size_t head[256];          ///< First pixel of each bucket
+    size_t tail[256];          ///< Last pixel of each bucket
+    int level;                 ///< Lowest bucket that may be non-empty
+
+public:
+    static constexpr size_t none = SIZE_MAX;  ///< Marks the end of a bucket
+
+    /**
+     * @brief Constructor
+     * @param size Number of pixels
+     */
+    explicit BucketQueue(size_t size) : next(size, none), level(0) {
+        std::fill(head, head + 256, none);
+        std::fill(tail, tail + 256, none);
+    }
+
+    /**
+     * @brief Adds a pixel
+     * @param pixel Pixel index
+     * @param priority Gray level, lower is popped first
+     */
+    void push(size_t pixel, int priority) {
+        next[pixel] = none;
+        if (tail[priority] == none) {
+            head[priority] = pixel;
+        } else {
+            next[tail[priority]] = pixel;
+        }
+        tail[priority] = pixel;
+        level = std::min(level, priority);
+    }
+
+    /**
+     * @brief Removes the oldest pixel of the lowest non-empty bucket
+     * @param pixel Receives the pixel index
+     * @param priority Receives its priority
+     * @return false if the queue is empty
+     */
+    bool pop(size_t& pixel, int& priority) {
+        while (level < 256 && head[level] == none) {
+            ++level;
+        }
+        if (level == 256) {
+            return false;
+        }
+        pixel = head[level];
+        priority = level;
+        head[level] = next[pixel];
+        if (head[level] == none) {
+            tail[level] = none;
+        }
+        return true;
+    }
+};
+
+}
+
+namespace Watershed {
+
+/**
+ * @brief Floods a gradient image from labelled markers
+ * @param gradient Gradient magnitude
+ * @param markers Initial labels
+ * @return Segmentation
+ * @details Meyer's flooding: unlabelled 4-neighbours of the markers are queued by gradient
+ *          value. A popped pixel whose labelled neighbours agree takes their label and
+ *          queues its own unlabelled neighbours; a pixel between two regions becomes a
+ *          watershed line. Priorities never drop below the level being flooded, so the
+ *          bucket queue only moves forward. Marker labels are mapped to dense indices
+ *          before flooding, so per-region storage depends on the number of regions and
+ *          not on the size of the label values
+ */
+Segmentation segment(const Image& gradient, const std::vector<int>& markers) {
+    Segmentation result;
+    unsigned int width = gradient.width();
+    unsigned int height = gradient.height();
+    size_t count = static_cast<size_t>(width) * height;
+    if (count == 0 || markers.size() != count) {
+        return result;
+    }
+
+    result.width = width;
+    result.height = height;
+
+    // Dense index of every distinct positive marker label, in label order
+    std::vector<int> ids;
+    for (int m : markers) {
+        if (m > 0) {
+            ids.push_back(m);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    result.labels.resize(count);
+    std::vector<int>& labels = result.labels;
+    for (size_t idx = 0; idx < count; ++idx) {
+        int m = markers[idx];
+        labels[idx] = m > 0 ? static_cast<int>(std::lower_bound(ids.begin(), ids.end(), m) - ids.begin()) + 1 : 0;
+    }
+
+    const int line = -1;
+    std::vector<unsigned char> queued(count, 0);
+    std::vector<const unsigned char*> rows(height);
+    for (unsigned int y = 0; y < height; ++y) {
+        rows[y] = gradient.row(y);
+    }
+
+    BucketQueue queue(count);
+    auto pushNeighbours = [&](size_t idx, int level) {
+        size_t x = idx % width, y = idx / width;
+        size_t n[4];
+        int k = 0;
+        if (x > 0) n[k++] = idx - 1;
+        if (x + 1 < width) n[k++] = idx + 1;
+        if (y > 0) n[k++] = idx - width;
+        if (y + 1 < height) n[k++] = idx + width;
+        for (int i = 0; i < k; ++i) {
+            if (labels[n[i]] == 0 && !queued[n[i]]) {
+                queued[n[i]] = 1;
+                size_t nx = n[i] % width, ny = n[i] / width;
+                queue.push(n[i], std::max(level, static_cast<int>(rows[ny][nx])));
+            }
+        }
+    };
+
+    for (size_t idx = 0; idx < count; ++idx) {
+        if (labels[idx] > 0) {
+            pushNeighbours(idx, 0);
+        }
+    }
+
+    size_t idx;
+    int level;
+    while (queue.pop(idx, level)) {
+        size_t x = idx % width, y = idx / width;
+        int label = 0;
+        bool conflict = false;
+        size_t n[4];
+        int k = 0;
+        if (x > 0) n[k++] = idx - 1;
+        if (x + 1 < width) n[k++] = idx + 1;
+        if (y > 0) n[k++] = idx - width;
+        if (y + 1 < height) n[k++] = idx + width;
+        for (int i = 0; i < k; ++i) {
+            int l = labels[n[i]];
+            if (l > 0) {
+                if (label == 0) {
+                    label = l;
+                } else if (l != label) {
+                    conflict = true;
+                }
+            }
+        }
+
+        if (conflict || label == 0) {
+            labels[idx] = line;
+            continue;
+        }
+        labels[idx] = label;
+        pushNeighbours(idx, level);
+    }
+
+    size_t regionCount = ids.size();
+    std::vector<int> minX(regionCount + 1, INT_MAX), minY(regionCount + 1, INT_MAX), maxX(regionCount + 1, -1), maxY(regionCount + 1, -1);
+    for (unsigned int y = 0; y < height; ++y) {
+        int* row = &labels[static_cast<size_t>(y) * width];
+        for (unsigned int x = 0; x < width; ++x) {
+            int l = row[x];
+            if (l == line) {
+                row[x] = 0;
+            } else if (l > 0) {
+                minX[l] = std::min(minX[l], static_cast<int>(x));
+                maxX[l] = std::max(maxX[l], static_cast<int>(x));
+                minY[l] = std::min(minY[l], static_cast<int>(y));
+                maxY[l] = std::max(maxY[l], static_cast<int>(y));
+                row[x] = ids[l - 1];
+            }
+        }
+    }
+
+    for (size_t l = 1; l <= regionCount; ++l) {
+        result.regions.emplace_hint(result.regions.end(), ids[l - 1],
+                                    Rectangle(minX[l], minY[l], maxX[l] - minX[l] + 1, maxY[l] - minY[l] + 1));
+    }
+    return result;
+}
+
+/**
+ * @brief Floods a gradient image from markers given as an image
+ * @param gradient Gradient magnitude
+ * @param markers Marker image
+ * @return Segmentation
+ */
+Segmentation segment(const Image& gradient, const Image& markers) {
+    if (markers.width() != gradient.width() || markers.height() != gradient.height()) {
+        return Segmentation();
+    }
+
+    std::vector<int> labels(static_cast<size_t>(markers.width()) * markers.height());
+    for (unsigned int y = 0; y < markers.height(); ++y) {
+        const unsigned char* in = markers.row(y);
+        for (unsigned int x = 0; x < markers.width(); ++x) {
+            labels[static_cast<size_t>(y) * markers.width() + x] = in[x];
+        }
+    }
+    return segment(gradient, labels);
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Image.h"
+#include "Rectangle.h"
+#include <map>
+#include <vector>
+
+/**
+ * @brief Structure holding the result of a segmentation
+ * @details labels has one entry per pixel in row-major order. Label 0 marks watershed
+ *          lines between regions and pixels no marker could reach
+ */
+struct Segmentation {
+    unsigned int width = 0;            ///< Width of the segmented image
+    unsigned int height = 0;           ///< Height of the segmented image
+    std::vector<int> labels;           ///< Region label of every pixel
+    std::map<int, Rectangle> regions;  ///< Bounding rectangle of every marker label
+
+    /**
+     * @brief Gets the label of a pixel
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @return Region label, 0 for watershed lines
+     */
+    int at(unsigned int x, unsigned int y) const { return labels[static_cast<size_t>(y) * width + x]; }
+};
+
+/**
+ * @brief Namespace containing marker-based watershed segmentation
+ */
+namespace Watershed {
+    /**
+     * @brief Floods a gradient image from labelled markers
+     * @param gradient Gradient magnitude (e.g. from Sobel), low values inside objects
+     * @param markers Initial label of every pixel, row-major: 0 unknown, >0 seed of that region
+     * @return Labels and per-region bounding rectangles, empty if the sizes do not match
+     */
+    Segmentation segment(const Image& gradient, const std::vector<int>& markers);
+
+    /**
+     * @brief Floods a gradient image from markers given as an image
+     * @param gradient Gradient magnitude
+     * @param markers Every non-zero pixel seeds the region with that value as label
+     * @return Labels and per-region bounding rectangles
+     */
+    Segmentation segment(const Image& gradient, const Image& markers);
+}
@@ -1,10 +1,17 @@
 #include "Image.h"
 #include "ImageProcessing.h"
 #include "Drawing.h"
+#include "Dithering.h"
+#include "Histogram.h"
+#include "PixelExpression.h"
+#include "BatchQueue.h"
+#include "Catalog.h"
 #include <iostream>
 #include <functional>
 #include <string>
+#include <vector>
 #include <fstream>
+#include <cstdlib>
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -12,22 +19,17 @@ namespace fs = std::filesystem;
 /**
  * @brief Validates if a file is a valid PGM file
  * @param filename The path to the file to validate
- * @return true if the file exists and has a .pgm extension, false otherwise
+ * @return true if the file has a .pgm extension and a binary (P5) header, false otherwise
+ * @details Only the header is read, the raster is left for Image::load
  */
 bool isValidPGMFile(const std::string& filename) {
-    // Check if file exists
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        return false;
-    }
-    file.close(); // Free
-
     // Check if file has .pgm extension
-    if (filename.length() < 4) {
+    if (filename.length() < 4 || filename.substr(filename.length() - 4) != ".pgm") {
         return false;
     }
-    std::string extension = filename.substr(filename.length() - 4);
-    return extension == ".pgm";
+
+    PGMInfo info;
+    return Image::probe(filename, info) && info.format == "P5";
 }
 
 /**
@@ -42,6 +44,9 @@ void printMenu() {
               << "4) Apply gamma correction\n"
               << "5) Apply convolution\n"
               << "6) Draw shape\n"
+              << "7) Apply dithering\n"
+              << "8) Match histogram to a reference image\n"
+              << "9) Apply pixel expression\n"
               << "0) Exit program\n"
               << "==========================\n";
 }
@@ -190,6 +195,130 @@ void handleConvolution(Image& img, const std::string& outputPath) {
     }
 }
 
+/**
+ * @brief Handles dithering of an image
+ * @param img The source image to process
+ * @param outputPath The directory path where the processed image will be saved
+ * @details Prompts user for the dithering method and number of gray levels,
+ *          applies the dithering, and saves the result
+ */
+void handleDithering(Image& img, const std::string& outputPath) {
+    std::cout << "Select dithering method:\n"
+              << "1) Ordered (Bayer 8x8)\n"
+              << "2) Floyd-Steinberg error diffusion\n"
+              << "Enter choice: ";
+    int method;
+    std::cin >> method;
+
+    unsigned int levels;
+    std::cout << "Enter number of gray levels (2 for black and white): ";
+    std::cin >> levels;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+    Image result;
+    std::string name;
+    if (method == 1) {
+        OrderedDithering od(levels);
+        od.process(img, result);
+        name = "ordered_dither.pgm";
+    } else if (method == 2) {
+        FloydSteinbergDithering fs(levels);
+        fs.process(img, result);
+        name = "floyd_steinberg.pgm";
+    } else {
+        std::cout << "Invalid dithering choice" << std::endl;
+        return;
+    }
+
+    std::string outputFile = outputPath.empty() ? name : outputPath + "/" + name;
+    if (result.save(outputFile)) {
+        std::cout << "Saved dithered image to: " << outputFile << std::endl;
+    } else {
+        std::cout << "Error saving the image" << std::endl;
+    }
+}
+
+/**
+ * @brief Handles histogram matching of an image
+ * @param img The source image to process
+ * @param outputPath The directory path where the processed image will be saved
+ * @details Prompts user for a reference PGM file, remaps the image so its histogram
+ *          matches the reference, and saves the result
+ */
+void handleHistogramMatching(Image& img, const std::string& outputPath) {
+    std::string referencePath;
+    std::cout << "Enter the path to the reference PGM file: ";
+    std::getline(std::cin, referencePath);
+
+    Image reference;
+    if (!isValidPGMFile(referencePath) || !reference.load(referencePath)) {
+        std::cout << "Error loading the reference image" << std::endl;
+        return;
+    }
+
+    Image result;
+    HistogramMatching hm(reference);
+    hm.process(img, result);
+
+    std::string outputFile = outputPath.empty() ?
+        "histogram_matched.pgm" :
+        outputPath + "/histogram_matched.pgm";
+
+    if (result.save(outputFile)) {
+        std::cout << "Saved histogram-matched image to: " << outputFile << std::endl;
+    } else {
+        std::cout << "Error saving the image" << std::endl;
+    }
+}
+
+/**
+ * @brief Handles evaluation of a per-pixel expression
+ * @param img The source image to process (variable a)
+ * @param outputPath The directory path where the processed image will be saved
+ * @details Prompts user for an expression such as "clamp((a - b) * 1.5 + 20)" and for
+ *          the PGM files of any further variables, evaluates it, and saves the result
+ */
+void handlePixelExpression(Image& img, const std::string& outputPath) {
+    std::string text;
+    std::cout << "Enter expression (variable a is the loaded image): ";
+    std::getline(std::cin, text);
+
+    PixelExpression expr;
+    if (!expr.compile(text)) {
+        std::cout << "Invalid expression: " << expr.error() << std::endl;
+        return;
+    }
+
+    std::vector<Image> extra(expr.inputCount() > 1 ? expr.inputCount() - 1 : 0);
+    std::vector<const Image*> inputs{&img};
+    for (unsigned int i = 0; i < extra.size(); ++i) {
+        std::string path;
+        std::cout << "Enter the path to the PGM file for variable " << static_cast<char>('b' + i) << ": ";
+        std::getline(std::cin, path);
+        if (!isValidPGMFile(path) || !extra[i].load(path)) {
+            std::cout << "Error loading the image" << std::endl;
+            return;
+        }
+        inputs.push_back(&extra[i]);
+    }
+
+    Image result;
+    if (!expr.evaluate(inputs, result)) {
+        std::cout << "All images must have the same dimensions" << std::endl;
+        return;
+    }
+
+    std::string outputFile = outputPath.empty() ?
+        "expression.pgm" :
+        outputPath + "/expression.pgm";
+
+    if (result.save(outputFile)) {
+        std::cout << "Saved expression result to: " << outputFile << std::endl;
+    } else {
+        std::cout << "Error saving the image" << std::endl;
+    }
+}
+
 /**
  * @brief Handles drawing operations on an image
  * @param img The source image to process
@@ -276,7 +405,112 @@ void drawShape(Image& img, const std::string& outputPath) {
     }
 }
 
-int main() {
+/**
+ * @brief Parses the command line of batch mode
+ * @param argc Argument count
+ * @param argv Arguments: --batch <job dir> [--workers N] [--retries N] [--expr E] [--metrics F] [--timeout S] [--lease S]
+ * @param options Receives the parsed settings
+ * @return true if the arguments are valid, false otherwise
+ */
+bool parseBatchOptions(int argc, char** argv, BatchOptions& options) {
+    if (argc < 3) {
+        return false;
+    }
+    options.jobDir = argv[2];
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--workers") {
+            options.workers = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (flag == "--retries") {
+            options.maxRetries = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (flag == "--expr") {
+            options.expression = value;
+        } else if (flag == "--metrics") {
+            options.metricsPath = value;
+        } else if (flag == "--timeout") {
+            options.timeout = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (flag == "--lease") {
+            options.lease = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    return (argc - 3) % 2 == 0;
+}
+
+/**
+ * @brief Refreshes a catalog and prints the images matching size limits
+ * @param argc Argument count
+ * @param argv Arguments: --catalog <catalog file> <root> [--histograms] [--min-width N] [--min-height N]
+ * @return Exit status
+ */
+int runCatalog(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --catalog <catalog file> <root> [--histograms] [--min-width N] [--min-height N]" << std::endl;
+        return 2;
+    }
+
+    bool histograms = false;
+    unsigned long minWidth = 0;
+    unsigned long minHeight = 0;
+    for (int i = 4; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--histograms") {
+            histograms = true;
+        } else if (flag == "--min-width" && i + 1 < argc) {
+            minWidth = std::strtoul(argv[++i], nullptr, 10);
+        } else if (flag == "--min-height" && i + 1 < argc) {
+            minHeight = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 2;
+        }
+    }
+
+    ImageCatalog catalog(argv[2]);
+    if (!catalog.load()) {
+        std::cerr << "Catalog " << argv[2] << " is malformed, rebuilding it" << std::endl;
+    }
+    CatalogRefresh stats = catalog.refresh(argv[3], histograms);
+    if (!catalog.save()) {
+        std::cerr << "Could not write catalog " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cerr << stats.scanned << " scanned, " << stats.updated << " updated, " << stats.unchanged << " unchanged, "
+              << stats.removed << " removed, " << stats.invalid << " invalid" << std::endl;
+    if (stats.error) {
+        std::cerr << "Walking " << argv[3] << " failed: " << stats.error.message() << "; no entries were removed" << std::endl;
+    }
+
+    for (const CatalogEntry* entry : catalog.query([&](const CatalogEntry& e) {
+             return e.info.width >= minWidth && e.info.height >= minHeight;
+         })) {
+        std::cout << entry->path << '\t' << entry->info.width << 'x' << entry->info.height << std::endl;
+    }
+    return stats.error ? 1 : 0;
+}
+
+/**
+ * @brief Main function of the image processing application
+ * @param argc Argument count
+ * @param argv Arguments; "--batch <job dir> ..." runs the job directory and
+ *             "--catalog <catalog file> <root> ..." queries a catalog without the menu
+ * @return Exit status
+ */
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        BatchOptions options;
+        if (!parseBatchOptions(argc, argv, options)) {
+            std::cerr << "Usage: " << argv[0] << " --batch <job dir> [--workers N] [--retries N] [--expr E] [--metrics F] [--timeout S] [--lease S]" << std::endl;
+            return 2;
+        }
+        return BatchMode::run(options);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--catalog") {
+        return runCatalog(argc, argv);
+    }
+
     std::string inputPath;
     std::string outputPath;
     Image img;
@@ -350,6 +584,30 @@ int main() {
                 drawShape(img, outputPath);
                 break;
 
+            case 7: // Dithering
+                if (!imageLoaded) {
+                    std::cout << "Please load an image first (Option 1)" << std::endl;
+                    break;
+                }
+                handleDithering(img, outputPath);
+                break;
+
+            case 8: // Histogram matching
+                if (!imageLoaded) {
+                    std::cout << "Please load an image first (Option 1)" << std::endl;
+                    break;
+                }
+                handleHistogramMatching(img, outputPath);
+                break;
+
+            case 9: // Pixel expression
+                if (!imageLoaded) {
+                    std::cout << "Please load an image first (Option 1)" << std::endl;
+                    break;
+                }
+                handlePixelExpression(img, outputPath);
+                break;
+
             default:
                 std::cout << "Invalid choice. Please try again." << std::endl;
         }